@@ -0,0 +1,132 @@
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include "crosstalk.h"
+
+#define CROSSTALK_ONE (1L << CROSSTALK_FRAC_BITS)
+#define CROSSTALK_MIN_PIVOT 1e-3
+
+void crosstalk_matrix_identity(crosstalk_matrix_t *matrix, uint8_t channels) {
+    memset(matrix, 0, sizeof(*matrix));
+    matrix->channels = channels;
+    for (uint8_t i = 0; i < channels; i++) {
+        matrix->coef[i][i] = CROSSTALK_ONE;
+    }
+}
+
+/* out = matrix * in, Q16 coefficients with 64-bit accumulation and rounding.
+   The matrix is linear, so any constant offset in the raw readings maps to a
+   constant offset in the output and drops out of frame-to-frame deltas. */
+void crosstalk_apply(const crosstalk_matrix_t *matrix, const long *in, long *out) {
+    for (uint8_t i = 0; i < matrix->channels; i++) {
+        const int32_t *row = matrix->coef[i];
+        int64_t acc = 1LL << (CROSSTALK_FRAC_BITS - 1);
+        for (uint8_t j = 0; j < matrix->channels; j++) {
+            acc += (int64_t)row[j] * in[j];
+        }
+        out[i] = (long)(acc >> CROSSTALK_FRAC_BITS);
+    }
+}
+
+void crosstalk_cal_init(crosstalk_cal_t *cal, uint8_t channels) {
+    memset(cal, 0, sizeof(*cal));
+    cal->channels = channels;
+}
+
+// Record the unloaded reading of every channel
+void crosstalk_cal_set_baseline(crosstalk_cal_t *cal, const long *frame) {
+    memcpy(cal->baseline, frame, cal->channels * sizeof(long));
+    cal->recorded = 0;
+}
+
+// Record the response of every channel while only `pad` is loaded
+bool crosstalk_cal_record_pad(crosstalk_cal_t *cal, uint8_t pad, const long *frame) {
+    if (pad >= cal->channels) {
+        return false;
+    }
+
+    for (uint8_t i = 0; i < cal->channels; i++) {
+        cal->response[i][pad] = frame[i] - cal->baseline[i];
+    }
+    cal->recorded |= 1 << pad;
+    return true;
+}
+
+/* Normalise each recorded column by the loaded pad's own response to get the
+   coupling matrix, then invert it with Gauss-Jordan elimination. Returns false if
+   a pad is missing, or the matrix is singular, or a pad barely responded: its own
+   response is below min_response or no larger than what a neighbour saw.
+   Dividing by such a response gives huge coupling terms and a meaningless inverse. */
+bool crosstalk_cal_solve(const crosstalk_cal_t *cal, long min_response, crosstalk_matrix_t *matrix) {
+    const uint8_t n = cal->channels;
+    double a[CROSSTALK_MAX_CHANNELS][CROSSTALK_MAX_CHANNELS];
+    double inv[CROSSTALK_MAX_CHANNELS][CROSSTALK_MAX_CHANNELS];
+
+    if (cal->recorded != (1 << n) - 1) {
+        return false;
+    }
+
+    for (uint8_t j = 0; j < n; j++) {
+        long self = cal->response[j][j];
+        if (self < min_response) {
+            return false;
+        }
+        for (uint8_t i = 0; i < n; i++) {
+            if (i != j && labs(cal->response[i][j]) >= self) {
+                return false;
+            }
+        }
+        for (uint8_t i = 0; i < n; i++) {
+            a[i][j] = (double)cal->response[i][j] / self;
+            inv[i][j] = (i == j) ? 1.0 : 0.0;
+        }
+    }
+
+    for (uint8_t col = 0; col < n; col++) {
+        uint8_t pivot = col;
+        for (uint8_t r = col + 1; r < n; r++) {
+            if (fabs(a[r][col]) > fabs(a[pivot][col])) {
+                pivot = r;
+            }
+        }
+        if (fabs(a[pivot][col]) < CROSSTALK_MIN_PIVOT) {
+            return false;
+        }
+
+        if (pivot != col) {
+            for (uint8_t k = 0; k < n; k++) {
+                double t = a[col][k]; a[col][k] = a[pivot][k]; a[pivot][k] = t;
+                t = inv[col][k]; inv[col][k] = inv[pivot][k]; inv[pivot][k] = t;
+            }
+        }
+
+        double scale = 1.0 / a[col][col];
+        for (uint8_t k = 0; k < n; k++) {
+            a[col][k] *= scale;
+            inv[col][k] *= scale;
+        }
+
+        for (uint8_t r = 0; r < n; r++) {
+            if (r == col) {
+                continue;
+            }
+            double f = a[r][col];
+            for (uint8_t k = 0; k < n; k++) {
+                a[r][k] -= f * a[col][k];
+                inv[r][k] -= f * inv[col][k];
+            }
+        }
+    }
+
+    crosstalk_matrix_identity(matrix, n);
+    for (uint8_t i = 0; i < n; i++) {
+        for (uint8_t j = 0; j < n; j++) {
+            double q = inv[i][j] * CROSSTALK_ONE;
+            if (q > INT32_MAX || q < INT32_MIN) {
+                return false;
+            }
+            matrix->coef[i][j] = (int32_t)lround(q);
+        }
+    }
+    return true;
+}
@@ -0,0 +1,34 @@
+#ifndef CROSSTALK_H
+#define CROSSTALK_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define CROSSTALK_MAX_CHANNELS 4
+#define CROSSTALK_FRAC_BITS 16 // Q16 fixed-point coefficients
+
+/* Decoupling matrix: the inverse of the learned coupling matrix, applied to every
+   multi-channel frame before step detection. Stored as-is in NVS. */
+typedef struct {
+    uint8_t channels;
+    int32_t coef[CROSSTALK_MAX_CHANNELS][CROSSTALK_MAX_CHANNELS];
+} crosstalk_matrix_t;
+
+/* Calibration state. response[i][j] is the change seen on channel i while pad j
+   is loaded, relative to the unloaded baseline. */
+typedef struct {
+    uint8_t channels;
+    uint8_t recorded; // Bitmask of pads recorded so far
+    long baseline[CROSSTALK_MAX_CHANNELS];
+    long response[CROSSTALK_MAX_CHANNELS][CROSSTALK_MAX_CHANNELS];
+} crosstalk_cal_t;
+
+void crosstalk_matrix_identity(crosstalk_matrix_t *matrix, uint8_t channels);
+void crosstalk_apply(const crosstalk_matrix_t *matrix, const long *in, long *out);
+
+void crosstalk_cal_init(crosstalk_cal_t *cal, uint8_t channels);
+void crosstalk_cal_set_baseline(crosstalk_cal_t *cal, const long *frame);
+bool crosstalk_cal_record_pad(crosstalk_cal_t *cal, uint8_t pad, const long *frame);
+bool crosstalk_cal_solve(const crosstalk_cal_t *cal, long min_response, crosstalk_matrix_t *matrix);
+
+#endif // CROSSTALK_H
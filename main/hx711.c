@@ -1,7 +1,9 @@
+#include "sdkconfig.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "driver/gpio.h"
 #include "esp_log.h"
+#include "esp_timer.h"
 #include "hx711.h"
 
 #define TAG "HX711"
@@ -18,15 +20,58 @@ void hx711_init(HX711 *hx711, gpio_num_t dout, gpio_num_t pd_sck, uint8_t gain)
     hx711->PD_SCK = pd_sck;
     hx711->DOUT = dout;
 
+#if !CONFIG_DDRPAD_QEMU_BENCH // Stubbed under QEMU, and some of these pins are flash pins on the ESP32
     pinMode(hx711->PD_SCK, GPIO_MODE_OUTPUT);
     pinMode(hx711->DOUT, GPIO_MODE_INPUT);
+#endif
 
     hx711_set_gain(hx711, gain);
 }
 
-// Check if HX711 is ready
-bool hx711_is_ready(HX711 *hx711) {
-    return digitalRead(hx711->DOUT) == 0;
+// Timestamp the conversion at DRDY and wake the sampling task
+static void IRAM_ATTR hx711_drdy_isr(void *arg) {
+    HX711 *hx711 = (HX711 *)arg;
+    if (hx711->READING) {
+        return;
+    }
+
+    hx711->DRDY_US = esp_timer_get_time();
+    if (hx711->NOTIFY != NULL) {
+        BaseType_t woken = pdFALSE;
+        vTaskNotifyGiveFromISR(hx711->NOTIFY, &woken);
+        portYIELD_FROM_ISR(woken);
+    }
+}
+
+// Enable DRDY timestamping: DOUT falls when a new conversion is ready
+esp_err_t hx711_enable_drdy_irq(HX711 *hx711, TaskHandle_t notify) {
+    hx711->NOTIFY = notify;
+    hx711->DRDY_US = 0;
+
+    esp_err_t ret = gpio_install_isr_service(0);
+    if (ret != ESP_OK && ret != ESP_ERR_INVALID_STATE) { // Already installed by another channel
+        ESP_LOGE(TAG, "Failed to install GPIO ISR service: %s", esp_err_to_name(ret));
+        return ret;
+    }
+
+    gpio_set_intr_type(hx711->DOUT, GPIO_INTR_NEGEDGE);
+    ret = gpio_isr_handler_add(hx711->DOUT, hx711_drdy_isr, hx711);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to add DRDY handler: %s", esp_err_to_name(ret));
+        return ret;
+    }
+
+    hx711->DRDY_IRQ = true;
+    return gpio_intr_enable(hx711->DOUT);
+}
+
+// Time of the last DRDY. The 64-bit timestamp isn't written atomically, so re-read until stable
+int64_t hx711_get_drdy_time(HX711 *hx711) {
+    int64_t t;
+    do {
+        t = hx711->DRDY_US;
+    } while (t != hx711->DRDY_US);
+    return t;
 }
 
 // Set gain
@@ -44,6 +89,34 @@ void hx711_set_gain(HX711 *hx711, uint8_t gain) {
     }
 }
 
+#if CONFIG_DDRPAD_QEMU_BENCH
+#define HX711_STUB_BASELINE 100000
+#define HX711_STUB_LOAD 50000
+
+// No load cells under QEMU: report ready every time and read a synthetic step pattern
+bool hx711_is_ready(HX711 *hx711) {
+    return true;
+}
+
+long hx711_read(HX711 *hx711) {
+    if (hx711 == NULL) {
+        ESP_LOGE(TAG, "hx711 pointer is NULL");
+        return -1;
+    }
+
+    // Stagger each channel by its DOUT pin so steps on different pads don't coincide
+    const int64_t period_us = CONFIG_DDRPAD_QEMU_BENCH_STEP_PERIOD_MS * 1000LL;
+    int64_t t = esp_timer_get_time() + (int64_t)hx711->DOUT * period_us / 8;
+    bool loaded = (t % period_us) < (period_us / 2);
+
+    return HX711_STUB_BASELINE + (loaded ? HX711_STUB_LOAD : 0);
+}
+#else
+// Check if HX711 is ready
+bool hx711_is_ready(HX711 *hx711) {
+    return digitalRead(hx711->DOUT) == 0;
+}
+
 long hx711_read(HX711 *hx711) {
     if (hx711 == NULL) {
         ESP_LOGE(TAG, "hx711 pointer is NULL");
@@ -56,6 +129,12 @@ long hx711_read(HX711 *hx711) {
     uint8_t data[3] = {0};
     uint8_t filler = 0x00;
 
+    // Data bits toggle DOUT, keep them out of the DRDY timestamp
+    hx711->READING = true;
+    if (hx711->DRDY_IRQ) {
+        gpio_intr_disable(hx711->DOUT);
+    }
+
     portMUX_TYPE mux = portMUX_INITIALIZER_UNLOCKED;
     portENTER_CRITICAL(&mux);
 
@@ -77,6 +156,11 @@ long hx711_read(HX711 *hx711) {
 
     portEXIT_CRITICAL(&mux);
 
+    if (hx711->DRDY_IRQ) {
+        gpio_intr_enable(hx711->DOUT);
+    }
+    hx711->READING = false;
+
     if (data[2] & 0x80) {
         filler = 0xFF;
     } else {
@@ -93,6 +177,7 @@ long hx711_read(HX711 *hx711) {
 
     return (long)value;
 }
+#endif // CONFIG_DDRPAD_QEMU_BENCH
 
 // Wait for HX711 to be ready
 void hx711_wait_ready(HX711 *hx711, unsigned long delay_ms) {
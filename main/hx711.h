@@ -1,6 +1,8 @@
 #ifndef HX711_H
 #define HX711_H
 
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
 #include "driver/gpio.h"
 #include "esp_err.h"
 #include "esp_http_server.h"
@@ -20,6 +22,10 @@ typedef struct {
     uint8_t GAIN;
     long OFFSET;
     float SCALE;
+    volatile int64_t DRDY_US;   // esp_timer time of the last DRDY falling edge
+    volatile bool READING;      // Set while shifting out, DOUT edges are data bits
+    bool DRDY_IRQ;
+    TaskHandle_t NOTIFY;        // Task notified on DRDY, may be NULL
 } HX711;
 
 void hx711_init(HX711 *hx711, gpio_num_t dout, gpio_num_t pd_sck, uint8_t gain);
@@ -37,6 +43,8 @@ void hx711_set_scale(HX711 *hx711, float scale);
 float hx711_get_scale(HX711 *hx711);
 void hx711_set_offset(HX711 *hx711, long offset);
 long hx711_get_offset(HX711 *hx711);
+esp_err_t hx711_enable_drdy_irq(HX711 *hx711, TaskHandle_t notify);
+int64_t hx711_get_drdy_time(HX711 *hx711);
 void hx711_power_down(HX711 *hx711);
 void hx711_power_up(HX711 *hx711);
 uint8_t hx711_shift_in_slow(gpio_num_t dataPin, gpio_num_t clockPin, uint8_t bitOrder);
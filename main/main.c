@@ -1,4 +1,8 @@
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "sdkconfig.h"
 #include "esp_system.h"
 #include "driver/gpio.h"
 #include "driver/i2s_std.h"
@@ -8,14 +12,27 @@
 #include "nvs_flash.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "freertos/semphr.h"
 #include "FreeRTOSConfig.h"
 #include "esp_task_wdt.h"
 #include "esp_wifi.h"
 #include "esp_event.h"
 #include "esp_https_ota.h"
-#include "HX711.h"
+#include "esp_timer.h"
+#include "esp_heap_caps.h"
+#if CONFIG_DDRPAD_QEMU_BENCH
+#include "esp_eth.h"
+#include "esp_netif.h"
+#endif
+#include "hx711.h"
 #include "i2s_config.h"
-#include "wifi_credentials.h"
+#include "usb_hid.h"
+#include "crosstalk.h"
+#include "phase_merge.h"
+#include "step_detect.h"
+#if !CONFIG_DDRPAD_QEMU_BENCH
+#include "wifi_credentials.h" // Not in the tree, the QEMU benchmark builds without it
+#endif
 
 #define WIFI_CONNECT_MAX_RETRY 10 // Maximum number of retries to connect to wifi
 
@@ -25,10 +42,50 @@
 #define HX711_2_DT GPIO_NUM_5 // Data pin for HX711 2
 #define HX711_3_DT GPIO_NUM_6 // Data pin for HX711 3
 #define HX711_4_DT GPIO_NUM_7 // Data pin for HX711 4
+#if CONFIG_DDRPAD_HX711_SEPARATE_SCK
+// Per-HX711 clock pins on boards that route them separately
+#define HX711_1_SCK CONFIG_DDRPAD_HX711_1_SCK_GPIO
+#define HX711_2_SCK CONFIG_DDRPAD_HX711_2_SCK_GPIO
+#define HX711_3_SCK CONFIG_DDRPAD_HX711_3_SCK_GPIO
+#define HX711_4_SCK CONFIG_DDRPAD_HX711_4_SCK_GPIO
+#if HX711_1_SCK == HX711_2_SCK || HX711_1_SCK == HX711_3_SCK || HX711_1_SCK == HX711_4_SCK || \
+    HX711_2_SCK == HX711_3_SCK || HX711_2_SCK == HX711_4_SCK || HX711_3_SCK == HX711_4_SCK
+#error "CONFIG_DDRPAD_HX711_SEPARATE_SCK is set but two HX711s share a PD_SCK GPIO"
+#endif
+#else
+#define HX711_1_SCK HX711_SCK
+#define HX711_2_SCK HX711_SCK
+#define HX711_3_SCK HX711_SCK
+#define HX711_4_SCK HX711_SCK
+#endif
+#if CONFIG_DDRPAD_QEMU_BENCH
+// The QEMU benchmark runs on an ESP32, where GPIO 35-38 are input-only
+#define LED_1_GATE GPIO_NUM_25
+#define LED_2_GATE GPIO_NUM_26
+#define LED_3_GATE GPIO_NUM_27
+#define LED_4_GATE GPIO_NUM_32
+#else
 #define LED_1_GATE GPIO_NUM_35 // Gate for LED 1
 #define LED_2_GATE GPIO_NUM_36 // Gate for LED 2
 #define LED_3_GATE GPIO_NUM_37 // Gate for LED 3
 #define LED_4_GATE GPIO_NUM_38 // Gate for LED 4
+#endif
+
+#define PAD_COUNT 4
+#define CROSSTALK_CAL_SAMPLES 16 // Frames averaged for each calibration step
+#define CROSSTALK_CAL_TIMEOUT_MS 1000
+#define NVS_NAMESPACE "ddrpad"
+#define NVS_KEY_CROSSTALK "xtalk"
+#define SAMPLE_PERIOD_MS 12 // hx711_task loop period
+#define HX711_CONVERSION_US 12500 // Nominal HX711 conversion period at 80 SPS
+#define HX711_COUNT 4
+#if CONFIG_DDRPAD_PHASE_MERGE_INTERPOLATE
+#define PHASE_MERGE_MODE PHASE_MERGE_INTERPOLATE
+#elif CONFIG_DDRPAD_PHASE_MERGE_EXTRAPOLATE
+#define PHASE_MERGE_MODE PHASE_MERGE_EXTRAPOLATE
+#else
+#define PHASE_MERGE_MODE PHASE_MERGE_HOLD
+#endif
 
 // Define threshold values
 long threshold = 10000; // Delta threshold for pad step detection
@@ -40,8 +97,74 @@ static const char *TAG = "main";
 static int retry_count = 0;
 
 HX711 scale1, scale2, scale3, scale4;
-
-long prevWeight1, prevWeight2, prevWeight3, prevWeight4;
+HX711 *scales[PAD_COUNT] = {&scale1, &scale2, &scale3, &scale4};
+const gpio_num_t led_gates[PAD_COUNT] = {LED_1_GATE, LED_2_GATE, LED_3_GATE, LED_4_GATE};
+
+long prevWeights[PAD_COUNT];
+static step_detector_t detectors[PAD_COUNT];
+
+// Newest pad state, read by the USB HID report scheduler
+pad_state_mailbox_t pad_state;
+
+// Panel each HX711 belongs to. One cell per panel on this board; with staggered
+// sampling, cells sharing a panel are merged into one higher-rate stream.
+const uint8_t cell_panel[HX711_COUNT] = {0, 1, 2, 3};
+
+#if CONFIG_DDRPAD_PHASE_STAGGERED
+static phase_panel_t panels[PAD_COUNT];
+static phase_window_t windows[PAD_COUNT];
+#endif
+
+// Decoupling matrix applied before detection, double-buffered so /calibrate can swap it in
+static crosstalk_matrix_t decoupling[2];
+static _Atomic int decoupling_active = 0;
+static crosstalk_cal_t crosstalk_cal;
+
+// Calibration frames are averaged by hx711_task so /calibrate never reads the HX711s itself
+static SemaphoreHandle_t cal_capture_done;
+static _Atomic int cal_capture_remaining = 0;
+static long long cal_capture_sum[PAD_COUNT];
+static long cal_capture_frame[PAD_COUNT];
+
+// Newest reading of every HX711, served by /hx711 so httpd never reads the HX711s itself
+static long last_raw[HX711_COUNT];
+static portMUX_TYPE last_raw_mux = portMUX_INITIALIZER_UNLOCKED;
+
+// Sampling-loop timing, reported by /stats
+typedef struct {
+    uint32_t count;
+    int64_t last_us;
+    int64_t min_us;
+    int64_t max_us;
+    int64_t sum_us;
+    uint64_t sum_sq_us;
+} loop_stats_t;
+
+static loop_stats_t loop_stats;
+static _Atomic bool loop_stats_reset = true;
+static TaskHandle_t hx711_task_handle;
+
+static void loop_stats_update(loop_stats_t *stats) {
+    int64_t now = esp_timer_get_time();
+
+    if (loop_stats_reset) {
+        memset(stats, 0, sizeof(*stats));
+        stats->min_us = INT64_MAX;
+        loop_stats_reset = false;
+    } else if (stats->last_us != 0) {
+        int64_t period = now - stats->last_us;
+        stats->count++;
+        stats->sum_us += period;
+        stats->sum_sq_us += (uint64_t)(period * period);
+        if (period < stats->min_us) {
+            stats->min_us = period;
+        }
+        if (period > stats->max_us) {
+            stats->max_us = period;
+        }
+    }
+    stats->last_us = now;
+}
 
 void init_gpio() {
     ESP_LOGI("GPIO", "Initializing GPIOs...");
@@ -66,6 +189,163 @@ void init_gpio() {
     ESP_LOGI("GPIO", "GPIOs Initialized.");
 }
 
+// Accumulate a frame for a pending calibration capture, called from hx711_task
+static void cal_capture_feed(const long *frame) {
+    int remaining = cal_capture_remaining;
+    if (remaining <= 0) {
+        return;
+    }
+
+    for (int i = 0; i < PAD_COUNT; i++) {
+        cal_capture_sum[i] += frame[i];
+    }
+
+    if (--remaining == 0) {
+        for (int i = 0; i < PAD_COUNT; i++) {
+            cal_capture_frame[i] = (long)(cal_capture_sum[i] / CROSSTALK_CAL_SAMPLES);
+        }
+        xSemaphoreGive(cal_capture_done);
+    }
+    cal_capture_remaining = remaining;
+}
+
+// Record readings of HX711s first .. first + count - 1, called from hx711_task
+static void last_raw_store(int first, const long *values, int count) {
+    portENTER_CRITICAL(&last_raw_mux);
+    memcpy(&last_raw[first], values, count * sizeof(long));
+    portEXIT_CRITICAL(&last_raw_mux);
+}
+
+// Ask hx711_task for the average of the next CROSSTALK_CAL_SAMPLES frames
+static esp_err_t cal_capture(long *frame) {
+    xSemaphoreTake(cal_capture_done, 0); // Drop a completion left over from a timed-out capture
+    memset(cal_capture_sum, 0, sizeof(cal_capture_sum));
+    cal_capture_remaining = CROSSTALK_CAL_SAMPLES;
+
+    if (xSemaphoreTake(cal_capture_done, pdMS_TO_TICKS(CROSSTALK_CAL_TIMEOUT_MS)) != pdTRUE) {
+        cal_capture_remaining = 0;
+        return ESP_ERR_TIMEOUT;
+    }
+
+    memcpy(frame, cal_capture_frame, sizeof(cal_capture_frame));
+    return ESP_OK;
+}
+
+// Update a pad's press latch with its weight and weight change, drives the pad LED
+static bool detect_step(int pad, long weight, long delta) {
+    bool pressed = step_detector_update(&detectors[pad], weight, delta, threshold);
+    gpio_set_level(led_gates[pad], pressed);
+    return pressed;
+}
+
+/* /calibrate swapped in another decoupling matrix. The detection history was
+   decoupled with the old one, and the matrix runs on absolute readings, so the
+   first delta across the swap would jump by (new - old) * raw. Shift each pad's
+   press level, and its delta window when staggered, by what the swap changes
+   in this frame. */
+static void decoupling_rebase(int from, int to, const long *frame) {
+    long before[PAD_COUNT], after[PAD_COUNT];
+    crosstalk_apply(&decoupling[from], frame, before);
+    crosstalk_apply(&decoupling[to], frame, after);
+
+    for (int i = 0; i < PAD_COUNT; i++) {
+        step_detector_rebase(&detectors[i], after[i] - before[i]);
+#if CONFIG_DDRPAD_PHASE_STAGGERED
+        phase_window_rebase(&windows[i], after[i] - before[i]);
+#endif
+    }
+}
+
+#if CONFIG_DDRPAD_PHASE_STAGGERED
+// Index of an HX711 among the cells of its panel
+static uint8_t panel_cell(int hx) {
+    uint8_t cell = 0;
+    for (int i = 0; i < hx; i++) {
+        cell += cell_panel[i] == cell_panel[hx];
+    }
+    return cell;
+}
+
+// Read each HX711 when its own conversion is ready, oldest DRDY first
+static void hx711_staggered_loop(void) {
+    int64_t consumed_us[HX711_COUNT] = {0};
+    long panel_weights[PAD_COUNT] = {0};
+    long weights[PAD_COUNT];
+    uint16_t pressed = 0;
+    int applied = decoupling_active; // Matrix the detection history was decoupled with
+
+    for (int p = 0; p < PAD_COUNT; p++) {
+        uint8_t cells = 0;
+        for (int i = 0; i < HX711_COUNT; i++) {
+            cells += cell_panel[i] == p;
+        }
+        phase_panel_init(&panels[p], cells, HX711_CONVERSION_US, PHASE_MERGE_MODE);
+        phase_window_init(&windows[p], cells, HX711_CONVERSION_US);
+    }
+
+    for (int i = 0; i < HX711_COUNT; i++) {
+        ESP_ERROR_CHECK(hx711_enable_drdy_irq(scales[i], xTaskGetCurrentTaskHandle()));
+    }
+
+    while (1) {
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(SAMPLE_PERIOD_MS * 2));
+        loop_stats_update(&loop_stats);
+
+        while (1) {
+            int next = -1;
+            int64_t next_us = 0;
+            for (int i = 0; i < HX711_COUNT; i++) {
+                int64_t drdy = hx711_get_drdy_time(scales[i]);
+                if (drdy != consumed_us[i] && hx711_is_ready(scales[i]) &&
+                    (next < 0 || drdy < next_us)) {
+                    next = i;
+                    next_us = drdy;
+                }
+            }
+            if (next < 0) {
+                break;
+            }
+
+            long raw = hx711_read(scales[next]);
+            consumed_us[next] = next_us;
+            if (raw == -1) {
+                continue;
+            }
+            last_raw_store(next, &raw, 1);
+
+            int p = cell_panel[next];
+            phase_sample_t sample;
+            if (!phase_panel_push(&panels[p], panel_cell(next), next_us, raw, &sample)) {
+                continue;
+            }
+            panel_weights[p] = sample.value;
+            cal_capture_feed(panel_weights);
+
+            int active = decoupling_active;
+            crosstalk_apply(&decoupling[active], panel_weights, weights);
+            bool swapped = active != applied;
+            if (swapped) {
+                decoupling_rebase(applied, active, panel_weights);
+                applied = active;
+            }
+
+            /* The stream is N times faster than the fixed-order loop, so compare over one
+               conversion period rather than between consecutive estimates */
+            long delta = phase_window_delta(&windows[p], sample.t_us, weights[p]);
+            if (swapped) {
+                continue; // Only re-seed on the swap sample
+            }
+            if (detect_step(p, weights[p], delta)) {
+                pressed |= 1 << p;
+            } else {
+                pressed &= ~(1 << p);
+            }
+            pad_state_publish(&pad_state, pressed);
+        }
+    }
+}
+#endif
+
 void hx711_task(void *pvParameter) {
 
     /* Initialization of HX711 load cell amplifiers 
@@ -82,10 +362,10 @@ void hx711_task(void *pvParameter) {
     /* End 128x amplification */
 
     /* Begin 64x amplification */
-    hx711_init(&scale1, HX711_1_DT, HX711_SCK, 64);
-    hx711_init(&scale2, HX711_2_DT, HX711_SCK, 64);
-    hx711_init(&scale3, HX711_3_DT, HX711_SCK, 64);
-    hx711_init(&scale4, HX711_4_DT, HX711_SCK, 64);
+    hx711_init(&scale1, HX711_1_DT, HX711_1_SCK, 64);
+    hx711_init(&scale2, HX711_2_DT, HX711_2_SCK, 64);
+    hx711_init(&scale3, HX711_3_DT, HX711_3_SCK, 64);
+    hx711_init(&scale4, HX711_4_DT, HX711_4_SCK, 64);
     /* End 64x amplification */
 
     /* Begin 32x amplification */
@@ -95,67 +375,277 @@ void hx711_task(void *pvParameter) {
     // hx711_init(&scale4, HX711_4_DT, HX711_SCK, 32);
     /* End 32x amplification */
 
+    for (int i = 0; i < PAD_COUNT; i++) {
+        step_detector_init(&detectors[i]);
+    }
+
+#if CONFIG_DDRPAD_PHASE_STAGGERED
+    hx711_staggered_loop();
+#endif
+
+    bool seeded = false; // prevWeights holds a valid frame
+    int applied = decoupling_active; // Matrix prevWeights and the press levels were decoupled with
+
     while (1) {
 
-        long weight1 = hx711_read(&scale1);
-        long weight2 = hx711_read(&scale2);
-        long weight3 = hx711_read(&scale3);
-        long weight4 = hx711_read(&scale4);
+        loop_stats_update(&loop_stats);
 
-        if (weight1 != -1) { 
-            if ((weight1 - threshold) > prevWeight1) {    
-                gpio_set_level(LED_1_GATE, 1);   
-            } else {  
-                gpio_set_level(LED_1_GATE, 0);
-            }
-            prevWeight1 = weight1;
-        }
-        
-        if (weight2 != -1) { 
-            if ((weight2 - threshold) > prevWeight2) {    
-                gpio_set_level(LED_2_GATE, 1);   
-            } else {   
-                gpio_set_level(LED_2_GATE, 0);
-            }
-            prevWeight2 = weight2;
-        }
+        long raw[PAD_COUNT];
+        long weights[PAD_COUNT];
+        bool valid = true;
+        uint16_t pressed = 0;
 
-        if (weight3 != -1) { 
-            if ((weight3 - threshold) > prevWeight3) {
-                gpio_set_level(LED_3_GATE, 1);   
-            } else {   
-                gpio_set_level(LED_3_GATE, 0);
-            }
-            prevWeight3 = weight3;
+        for (int i = 0; i < PAD_COUNT; i++) {
+            raw[i] = hx711_read(scales[i]);
+            valid &= raw[i] != -1;
         }
 
-        if (weight4 != -1) { 
-            if ((weight4 - threshold) > prevWeight4) {   
-                gpio_set_level(LED_4_GATE, 1);  
-            } else { 
-                gpio_set_level(LED_4_GATE, 0);
+        // Skip detection entirely on a bad frame so held pads stay held
+        if (valid) {
+            last_raw_store(0, raw, PAD_COUNT);
+            cal_capture_feed(raw);
+
+            // Remove cross-talk from neighbouring pads before detection
+            int active = decoupling_active;
+            crosstalk_apply(&decoupling[active], raw, weights);
+
+            /* The first frame only seeds prevWeights: against zero its delta is the whole
+               reading. A matrix swap re-seeds it the same way and skips detection. */
+            if (active != applied) {
+                decoupling_rebase(applied, active, raw);
+                applied = active;
+            } else if (seeded) {
+                for (int i = 0; i < PAD_COUNT; i++) {
+                    if (detect_step(i, weights[i], weights[i] - prevWeights[i])) {
+                        pressed |= 1 << i;
+                    }
+                }
+
+                // Hand the newest pad state to the USB HID report scheduler
+                pad_state_publish(&pad_state, pressed);
             }
-            prevWeight4 = weight4;
+            memcpy(prevWeights, weights, sizeof(prevWeights));
+            seeded = true;
         }
 
-        vTaskDelay(pdMS_TO_TICKS(12)); // Delay for 12ms = 80Hz sample rate from HX711
+        vTaskDelay(pdMS_TO_TICKS(SAMPLE_PERIOD_MS)); // Delay for 12ms = 80Hz sample rate from HX711
     }
 }
 
+// Serves the last frame hx711_task read: reading here would race its reads of the same chips
 esp_err_t hx711_get_handler(httpd_req_t *req) {
-    long sensor_value1 = hx711_read(&scale1);
-    long sensor_value2 = hx711_read(&scale2);
-    long sensor_value3 = hx711_read(&scale3);
-    long sensor_value4 = hx711_read(&scale4);
+    long values[HX711_COUNT];
+    portENTER_CRITICAL(&last_raw_mux);
+    memcpy(values, last_raw, sizeof(values));
+    portEXIT_CRITICAL(&last_raw_mux);
 
     char resp_str[256];
     snprintf(resp_str, sizeof(resp_str), 
              "HX711 Sensor Values:\nSensor 1: %ld\nSensor 2: %ld\nSensor 3: %ld\nSensor 4: %ld", 
-             sensor_value1, sensor_value2, sensor_value3, sensor_value4);
+             values[0], values[1], values[2], values[3]);
     httpd_resp_send(req, resp_str, strlen(resp_str));
     return ESP_OK;
 }
 
+/* Runtime statistics as JSON: heap and stack low-water marks, sampling-loop period
+   and jitter (standard deviation of the period), USB frame counters.
+   /stats?reset=1 restarts the loop timing window. */
+esp_err_t stats_get_handler(httpd_req_t *req) {
+    char query[32] = {0};
+    char reset[4] = {0};
+    char resp_str[1024];
+    loop_stats_t stats = loop_stats;
+
+    double mean_us = 0, jitter_us = 0;
+    if (stats.count > 0) {
+        mean_us = (double)stats.sum_us / stats.count;
+        double var = (double)stats.sum_sq_us / stats.count - mean_us * mean_us;
+        jitter_us = var > 0 ? sqrt(var) : 0;
+    } else {
+        stats.min_us = 0;
+    }
+
+    int len = snprintf(resp_str, sizeof(resp_str),
+             "{\"uptime_us\":%lld,\"heap_free\":%u,\"heap_min_free\":%u,\"heap_largest_free_block\":%u,"
+             "\"hx711_task_stack_min_free\":%u,"
+             "\"loop\":{\"nominal_us\":%d,\"count\":%lu,\"mean_us\":%.1f,\"min_us\":%lld,\"max_us\":%lld,\"jitter_us\":%.1f},"
+             "\"usb\":{\"frames\":%lu,\"idle_frames\":%lu}",
+             esp_timer_get_time(),
+             (unsigned)esp_get_free_heap_size(), (unsigned)esp_get_minimum_free_heap_size(),
+             (unsigned)heap_caps_get_largest_free_block(MALLOC_CAP_DEFAULT),
+             hx711_task_handle ? (unsigned)uxTaskGetStackHighWaterMark(hx711_task_handle) : 0,
+             SAMPLE_PERIOD_MS * 1000, (unsigned long)stats.count, mean_us, stats.min_us, stats.max_us, jitter_us,
+#if CONFIG_SOC_USB_OTG_SUPPORTED
+             (unsigned long)usb_hid_get_frames(), (unsigned long)usb_hid_get_idle_frames());
+#else
+             0UL, 0UL);
+#endif
+
+#if CONFIG_DDRPAD_PHASE_STAGGERED
+    // Tracked phase (last DRDY) and period of every cell, for drift monitoring
+    len += snprintf(resp_str + len, sizeof(resp_str) - len, ",\"cells\":[");
+    for (int i = 0; i < HX711_COUNT && len < (int)sizeof(resp_str); i++) {
+        int p = cell_panel[i];
+        const phase_cell_t *c = &panels[p].cell[panel_cell(i)];
+        len += snprintf(resp_str + len, sizeof(resp_str) - len,
+                        "%s{\"panel\":%d,\"phase_us\":%lld,\"period_us\":%lu,\"missed\":%lu}",
+                        i ? "," : "", p, c->last_us, (unsigned long)phase_cell_period_us(c), (unsigned long)c->missed);
+    }
+    if (len < (int)sizeof(resp_str)) {
+        len += snprintf(resp_str + len, sizeof(resp_str) - len, "]");
+    }
+#endif
+    if (len < (int)sizeof(resp_str)) {
+        snprintf(resp_str + len, sizeof(resp_str) - len, "}");
+    }
+
+    if (httpd_req_get_url_query_str(req, query, sizeof(query)) == ESP_OK &&
+        httpd_query_key_value(query, "reset", reset, sizeof(reset)) == ESP_OK && atoi(reset)) {
+        loop_stats_reset = true;
+    }
+
+    httpd_resp_set_type(req, "application/json");
+    httpd_resp_send(req, resp_str, strlen(resp_str));
+    return ESP_OK;
+}
+
+// Load the cross-talk decoupling matrix from NVS, falling back to identity
+static void crosstalk_load(void) {
+    crosstalk_matrix_t *matrix = &decoupling[decoupling_active];
+    crosstalk_matrix_identity(matrix, PAD_COUNT);
+
+    nvs_handle_t nvs;
+    if (nvs_open(NVS_NAMESPACE, NVS_READONLY, &nvs) != ESP_OK) {
+        ESP_LOGI(TAG, "No cross-talk calibration stored, using identity");
+        return;
+    }
+
+    crosstalk_matrix_t stored;
+    size_t len = sizeof(stored);
+    esp_err_t ret = nvs_get_blob(nvs, NVS_KEY_CROSSTALK, &stored, &len);
+    nvs_close(nvs);
+
+    if (ret == ESP_OK && len == sizeof(stored) && stored.channels == PAD_COUNT) {
+        *matrix = stored;
+        ESP_LOGI(TAG, "Loaded cross-talk calibration from NVS");
+    } else {
+        ESP_LOGI(TAG, "No cross-talk calibration stored, using identity");
+    }
+}
+
+static esp_err_t crosstalk_save(const crosstalk_matrix_t *matrix) {
+    nvs_handle_t nvs;
+    esp_err_t ret = nvs_open(NVS_NAMESPACE, NVS_READWRITE, &nvs);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    ret = nvs_set_blob(nvs, NVS_KEY_CROSSTALK, matrix, sizeof(*matrix));
+    if (ret == ESP_OK) {
+        ret = nvs_commit(nvs);
+    }
+    nvs_close(nvs);
+    return ret;
+}
+
+static esp_err_t crosstalk_erase(void) {
+    nvs_handle_t nvs;
+    esp_err_t ret = nvs_open(NVS_NAMESPACE, NVS_READWRITE, &nvs);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    ret = nvs_erase_key(nvs, NVS_KEY_CROSSTALK);
+    if (ret == ESP_ERR_NVS_NOT_FOUND) {
+        ret = ESP_OK; // Nothing stored
+    }
+    if (ret == ESP_OK) {
+        ret = nvs_commit(nvs);
+    }
+    nvs_close(nvs);
+    return ret;
+}
+
+/* Cross-talk calibration, driven step by step:
+   /calibrate?step=baseline        - nobody on the pad
+   /calibrate?step=pad&pad=<1..4>  - stand on that pad only
+   /calibrate?step=save            - solve, store in NVS and apply
+   /calibrate?step=reset           - revert to identity and erase the stored matrix
+   If NVS can't be written, save and reset still apply the new matrix for this
+   session and answer 500, saying the change is lost on reboot. */
+esp_err_t calibrate_get_handler(httpd_req_t *req) {
+    char query[64] = {0};
+    char step[16] = {0};
+    char pad_str[8] = {0};
+    char resp_str[160];
+    long frame[PAD_COUNT];
+
+    if (httpd_req_get_url_query_str(req, query, sizeof(query)) != ESP_OK ||
+        httpd_query_key_value(query, "step", step, sizeof(step)) != ESP_OK) {
+        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Missing step");
+        return ESP_FAIL;
+    }
+
+    if ((strcmp(step, "baseline") == 0 || strcmp(step, "pad") == 0) && cal_capture(frame) != ESP_OK) {
+        httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Timed out waiting for HX711 frames");
+        return ESP_FAIL;
+    }
+
+    if (strcmp(step, "baseline") == 0) {
+        crosstalk_cal_init(&crosstalk_cal, PAD_COUNT);
+        crosstalk_cal_set_baseline(&crosstalk_cal, frame);
+        snprintf(resp_str, sizeof(resp_str), "Baseline recorded");
+    } else if (strcmp(step, "pad") == 0) {
+        httpd_query_key_value(query, "pad", pad_str, sizeof(pad_str));
+        int pad = atoi(pad_str);
+        if (pad < 1 || pad > PAD_COUNT || !crosstalk_cal_record_pad(&crosstalk_cal, pad - 1, frame)) {
+            httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Invalid pad");
+            return ESP_FAIL;
+        }
+        snprintf(resp_str, sizeof(resp_str), "Pad %d recorded: %ld %ld %ld %ld", pad,
+                 crosstalk_cal.response[0][pad - 1], crosstalk_cal.response[1][pad - 1],
+                 crosstalk_cal.response[2][pad - 1], crosstalk_cal.response[3][pad - 1]);
+    } else if (strcmp(step, "save") == 0) {
+        int next = !decoupling_active;
+        // A pad must have moved its own cell by at least a step to be calibrated
+        if (!crosstalk_cal_solve(&crosstalk_cal, threshold, &decoupling[next])) {
+            httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR,
+                                "Calibration incomplete, singular, or a pad barely responded");
+            return ESP_FAIL;
+        }
+        esp_err_t ret = crosstalk_save(&decoupling[next]);
+        decoupling_active = next;
+        if (ret != ESP_OK) {
+            ESP_LOGE(TAG, "Failed to store cross-talk calibration: %s", esp_err_to_name(ret));
+            snprintf(resp_str, sizeof(resp_str),
+                     "Cross-talk calibration applied but not saved to NVS (%s), it will be lost on reboot",
+                     esp_err_to_name(ret));
+            httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, resp_str);
+            return ESP_FAIL;
+        }
+        snprintf(resp_str, sizeof(resp_str), "Cross-talk calibration saved");
+    } else if (strcmp(step, "reset") == 0) {
+        int next = !decoupling_active;
+        crosstalk_matrix_identity(&decoupling[next], PAD_COUNT);
+        esp_err_t ret = crosstalk_erase();
+        decoupling_active = next;
+        if (ret != ESP_OK) {
+            ESP_LOGE(TAG, "Failed to erase cross-talk calibration: %s", esp_err_to_name(ret));
+            snprintf(resp_str, sizeof(resp_str),
+                     "Cross-talk calibration reset but not erased from NVS (%s), it will be restored on reboot",
+                     esp_err_to_name(ret));
+            httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, resp_str);
+            return ESP_FAIL;
+        }
+        snprintf(resp_str, sizeof(resp_str), "Cross-talk calibration reset");
+    } else {
+        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Unknown step");
+        return ESP_FAIL;
+    }
+
+    httpd_resp_send(req, resp_str, strlen(resp_str));
+    return ESP_OK;
+}
 
 // Event handler for Wi-Fi events
 static void wifi_event_handler(void* arg, esp_event_base_t event_base, int32_t event_id, void* event_data) {
@@ -169,7 +659,7 @@ static void wifi_event_handler(void* arg, esp_event_base_t event_base, int32_t e
         } else {
             ESP_LOGI(TAG, "Failed to connect to the AP");
         }
-    } else if (event_base == IP_EVENT && event_id == IP_EVENT_STA_GOT_IP) {
+    } else if (event_base == IP_EVENT && (event_id == IP_EVENT_STA_GOT_IP || event_id == IP_EVENT_ETH_GOT_IP)) {
         ip_event_got_ip_t* event = (ip_event_got_ip_t*) event_data;
         char ip_str[IP4ADDR_STRLEN_MAX];
         esp_ip4addr_ntoa(&event->ip_info.ip, ip_str, IP4ADDR_STRLEN_MAX);
@@ -179,6 +669,7 @@ static void wifi_event_handler(void* arg, esp_event_base_t event_base, int32_t e
 }
 
 
+#if !CONFIG_DDRPAD_QEMU_BENCH
 // Initialize Wi-Fi as station
 void wifi_init_sta(void) {
     esp_netif_init();
@@ -207,6 +698,30 @@ void wifi_init_sta(void) {
     esp_wifi_set_max_tx_power(34);
 }
 
+#else
+// Bring up networking on the QEMU OpenCores Ethernet MAC instead of Wi-Fi
+void eth_init_qemu(void) {
+    esp_netif_init();
+    esp_event_loop_create_default();
+
+    esp_netif_config_t netif_cfg = ESP_NETIF_DEFAULT_ETH();
+    esp_netif_t *eth_netif = esp_netif_new(&netif_cfg);
+
+    eth_mac_config_t mac_config = ETH_MAC_DEFAULT_CONFIG();
+    eth_phy_config_t phy_config = ETH_PHY_DEFAULT_CONFIG();
+    phy_config.autonego_timeout_ms = 100;
+    esp_eth_mac_t *mac = esp_eth_mac_new_openeth(&mac_config);
+    esp_eth_phy_t *phy = esp_eth_phy_new_dp83848(&phy_config);
+
+    esp_eth_config_t eth_config = ETH_DEFAULT_CONFIG(mac, phy);
+    esp_eth_handle_t eth_handle = NULL;
+    ESP_ERROR_CHECK(esp_eth_driver_install(&eth_config, &eth_handle));
+    ESP_ERROR_CHECK(esp_netif_attach(eth_netif, esp_eth_new_netif_glue(eth_handle)));
+    esp_event_handler_instance_register(IP_EVENT, IP_EVENT_ETH_GOT_IP, &wifi_event_handler, NULL, NULL);
+    ESP_ERROR_CHECK(esp_eth_start(eth_handle));
+}
+#endif
+
 // HTTP Server Handlers
 esp_err_t hello_get_handler(httpd_req_t *req) {
     const char* resp_str = "Welcome to the DDR Dance Pad Controller!";
@@ -233,6 +748,20 @@ void start_webserver(void) {
             .handler  = hx711_get_handler,
         };
         httpd_register_uri_handler(server, &uri_hx711);
+
+        httpd_uri_t uri_calibrate = {
+            .uri      = "/calibrate",
+            .method   = HTTP_GET,
+            .handler  = calibrate_get_handler,
+        };
+        httpd_register_uri_handler(server, &uri_calibrate);
+
+        httpd_uri_t uri_stats = {
+            .uri      = "/stats",
+            .method   = HTTP_GET,
+            .handler  = stats_get_handler,
+        };
+        httpd_register_uri_handler(server, &uri_stats);
     }
 }
 
@@ -251,14 +780,28 @@ void app_main(void) {
     // Initialize GPIOs
     init_gpio();
 
+    // Load cross-talk decoupling matrix
+    crosstalk_load();
+    cal_capture_done = xSemaphoreCreateBinary();
+
+#if CONFIG_DDRPAD_QEMU_BENCH
+    // Initialize emulated Ethernet
+    eth_init_qemu();
+#else
     // Initialize Wi-Fi
     wifi_init_sta();
+#endif
 
     // Start web server 
     start_webserver();
 
+#if CONFIG_SOC_USB_OTG_SUPPORTED && !CONFIG_DDRPAD_QEMU_BENCH
+    // Initialize USB HID gamepad output
+    ESP_ERROR_CHECK(usb_hid_init());
+#endif
+
     // Initialize HX711 task to read load cell values
-    xTaskCreate(&hx711_task, "hx711_task", 4096, NULL, configMAX_PRIORITIES - 1, NULL);
+    xTaskCreate(&hx711_task, "hx711_task", 4096, NULL, configMAX_PRIORITIES - 1, &hx711_task_handle);
 
     // TODO: Implement I2S audio input
     // Initialize I2S
@@ -0,0 +1,62 @@
+#include <string.h>
+#include "pad_report.h"
+
+// Publish the detector's pad bitmask. Only the detector task writes, so a plain
+// load/store pair is enough; the sequence only advances when the state changes.
+void pad_state_publish(pad_state_mailbox_t *mailbox, uint16_t buttons) {
+    uint32_t prev = atomic_load_explicit(&mailbox->word, memory_order_relaxed);
+    if ((uint16_t)prev == buttons) {
+        return;
+    }
+
+    uint32_t seq = ((prev >> 16) + 1) & 0xFFFF;
+    atomic_store_explicit(&mailbox->word, (seq << 16) | buttons, memory_order_release);
+}
+
+// Read the newest published state without blocking the writer
+pad_state_t pad_state_latest(pad_state_mailbox_t *mailbox) {
+    uint32_t word = atomic_load_explicit(&mailbox->word, memory_order_acquire);
+    pad_state_t state = {
+        .buttons = (uint16_t)word,
+        .seq = (uint16_t)(word >> 16),
+    };
+    return state;
+}
+
+// Encode a gamepad report into buf. Returns the report length, or 0 if buf is too small.
+size_t pad_report_encode(uint16_t buttons, uint8_t *buf, size_t len) {
+    if (len < PAD_REPORT_SIZE) {
+        return 0;
+    }
+
+    memset(buf, 0, PAD_REPORT_HAT_OFFSET); // Axes centred
+    buf[PAD_REPORT_HAT_OFFSET] = PAD_REPORT_HAT_CENTERED;
+    buf[PAD_REPORT_BUTTONS_OFFSET + 0] = (uint8_t)buttons;
+    buf[PAD_REPORT_BUTTONS_OFFSET + 1] = (uint8_t)(buttons >> 8);
+    buf[PAD_REPORT_BUTTONS_OFFSET + 2] = 0;
+    buf[PAD_REPORT_BUTTONS_OFFSET + 3] = 0;
+
+    return PAD_REPORT_SIZE;
+}
+
+void pad_report_scheduler_init(pad_report_scheduler_t *scheduler) {
+    memset(scheduler, 0, sizeof(*scheduler));
+    pad_report_encode(0, scheduler->report, sizeof(scheduler->report));
+}
+
+// Build the report for the next USB frame from the newest mailbox state.
+// Returns true if the state changed since the previous frame.
+bool pad_report_scheduler_frame(pad_report_scheduler_t *scheduler, pad_state_mailbox_t *mailbox) {
+    pad_state_t state = pad_state_latest(mailbox);
+    bool changed = state.seq != scheduler->last.seq;
+
+    scheduler->frames++;
+    if (changed) {
+        pad_report_encode(state.buttons, scheduler->report, sizeof(scheduler->report));
+        scheduler->last = state;
+    } else {
+        scheduler->idle_frames++;
+    }
+
+    return changed;
+}
@@ -0,0 +1,44 @@
+#ifndef PAD_REPORT_H
+#define PAD_REPORT_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* Gamepad input report, laid out to match TinyUSB's TUD_HID_REPORT_DESC_GAMEPAD:
+   int8 x, y, z, rz, rx, ry | uint8 hat | uint32 buttons (little-endian) */
+#define PAD_REPORT_SIZE 11
+#define PAD_REPORT_HAT_OFFSET 6
+#define PAD_REPORT_BUTTONS_OFFSET 7
+#define PAD_REPORT_HAT_CENTERED 0
+
+/* Latest-state mailbox between the step detector and the USB report scheduler.
+   Low 16 bits hold the pressed-pad bitmask (bit n = pad n + 1), high 16 bits a
+   sequence number bumped on every state change. Packing both into one word keeps
+   the mailbox lock-free: the writer never waits on the reader and vice versa. */
+typedef struct {
+    _Atomic uint32_t word;
+} pad_state_mailbox_t;
+
+typedef struct {
+    uint16_t buttons;
+    uint16_t seq;
+} pad_state_t;
+
+typedef struct {
+    uint8_t report[PAD_REPORT_SIZE]; // Preallocated report buffer handed to the USB stack
+    pad_state_t last;                // State carried by the previous report
+    uint32_t frames;                 // Reports sent
+    uint32_t idle_frames;            // Reports that carried no state change
+} pad_report_scheduler_t;
+
+void pad_state_publish(pad_state_mailbox_t *mailbox, uint16_t buttons);
+pad_state_t pad_state_latest(pad_state_mailbox_t *mailbox);
+
+size_t pad_report_encode(uint16_t buttons, uint8_t *buf, size_t len);
+
+void pad_report_scheduler_init(pad_report_scheduler_t *scheduler);
+bool pad_report_scheduler_frame(pad_report_scheduler_t *scheduler, pad_state_mailbox_t *mailbox);
+
+#endif // PAD_REPORT_H
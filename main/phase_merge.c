@@ -0,0 +1,152 @@
+#include <string.h>
+#include "phase_merge.h"
+
+void phase_panel_init(phase_panel_t *panel, uint8_t cells, uint32_t nominal_period_us, phase_merge_mode_t mode) {
+    memset(panel, 0, sizeof(*panel));
+    panel->cells = cells;
+    panel->mode = mode;
+    panel->nominal_period_us = nominal_period_us;
+    for (uint8_t i = 0; i < cells; i++) {
+        panel->cell[i].period_q8 = (int32_t)(nominal_period_us << PHASE_PERIOD_FRAC_BITS);
+    }
+}
+
+uint32_t phase_cell_period_us(const phase_cell_t *cell) {
+    return (uint32_t)((cell->period_q8 + (1 << (PHASE_PERIOD_FRAC_BITS - 1))) >> PHASE_PERIOD_FRAC_BITS);
+}
+
+// Track the cell's conversion period from successive DRDY timestamps
+static void phase_cell_track(phase_cell_t *cell, int64_t drdy_us) {
+    if (cell->conversions == 0) {
+        return;
+    }
+
+    int64_t interval_q8 = (drdy_us - cell->last_us) << PHASE_PERIOD_FRAC_BITS;
+    int64_t periods = (interval_q8 + cell->period_q8 / 2) / cell->period_q8;
+    if (periods < 1) {
+        return;
+    }
+
+    // Spread a gap over the conversions it covers so a missed DRDY doesn't skew the period
+    int32_t measured_q8 = (int32_t)(interval_q8 / periods);
+    cell->period_q8 += (measured_q8 - cell->period_q8) >> PHASE_PERIOD_SMOOTHING;
+    cell->missed += (uint32_t)(periods - 1);
+}
+
+/* Predict a cell's value at t_us from its last two conversions. Prediction is
+   limited to one tracked period past the last conversion; older cells hold. */
+static long phase_cell_predict(const phase_cell_t *cell, int64_t t_us) {
+    if (cell->conversions < 2 || cell->last_us <= cell->prev_us) {
+        return cell->last_value;
+    }
+
+    int64_t age = t_us - cell->last_us;
+    int64_t span = cell->last_us - cell->prev_us;
+    int64_t limit = phase_cell_period_us(cell);
+    if (age <= 0) {
+        return cell->last_value;
+    }
+    if (age > limit) {
+        age = limit;
+    }
+
+    return cell->last_value + (long)((int64_t)(cell->last_value - cell->prev_value) * age / span);
+}
+
+// Linear interpolation between a cell's last two conversions, clamped to them
+static long phase_cell_interpolate(const phase_cell_t *cell, int64_t t_us) {
+    if (t_us >= cell->last_us || cell->conversions < 2 || cell->last_us <= cell->prev_us) {
+        return cell->last_value;
+    }
+    if (t_us <= cell->prev_us) {
+        return cell->prev_value;
+    }
+
+    return cell->prev_value + (long)((int64_t)(cell->last_value - cell->prev_value) *
+                                     (t_us - cell->prev_us) / (cell->last_us - cell->prev_us));
+}
+
+/* Feed one conversion, timestamped at DRDY. Conversions must be pushed in
+   timestamp order. On success, out holds the panel estimate (sum of all cells)
+   at drdy_us, or one nominal period earlier when interpolating. Returns false
+   until every cell has converted at least once. */
+bool phase_panel_push(phase_panel_t *panel, uint8_t cell, int64_t drdy_us, long value, phase_sample_t *out) {
+    if (cell >= panel->cells || drdy_us < panel->last_in_us) {
+        return false;
+    }
+    panel->last_in_us = drdy_us;
+
+    phase_cell_t *c = &panel->cell[cell];
+    phase_cell_track(c, drdy_us);
+    c->prev_us = c->last_us;
+    c->prev_value = c->last_value;
+    c->last_us = drdy_us;
+    c->last_value = value;
+    c->conversions++;
+
+    int64_t t_us = drdy_us;
+    if (panel->mode == PHASE_MERGE_INTERPOLATE) {
+        t_us -= panel->nominal_period_us;
+    }
+
+    long sum = 0;
+    for (uint8_t i = 0; i < panel->cells; i++) {
+        const phase_cell_t *c = &panel->cell[i];
+        if (c->conversions == 0) {
+            return false;
+        }
+        if (panel->mode == PHASE_MERGE_INTERPOLATE) {
+            sum += phase_cell_interpolate(c, t_us);
+        } else if (panel->mode == PHASE_MERGE_EXTRAPOLATE && i != cell) {
+            sum += phase_cell_predict(c, t_us);
+        } else {
+            sum += c->last_value;
+        }
+    }
+
+    out->t_us = t_us;
+    out->value = sum;
+    return true;
+}
+
+/* The window is just under one conversion period: with N staggered cells the
+   reference is the estimate about N samples back, with a single cell it is the
+   previous sample, the same delta the fixed-order loop uses. */
+void phase_window_init(phase_window_t *window, uint8_t cells, uint32_t nominal_period_us) {
+    memset(window, 0, sizeof(*window));
+    window->window_us = nominal_period_us - nominal_period_us / (2 * (cells ? cells : 1));
+}
+
+/* Change of value over the window: against the newest stored estimate at least
+   window_us old, or the oldest one while history is short. Returns 0 for the first
+   estimate. */
+long phase_window_delta(phase_window_t *window, int64_t t_us, long value) {
+    long delta = 0;
+
+    if (window->count > 0) {
+        uint8_t ref = (window->head + PHASE_WINDOW_DEPTH - window->count) % PHASE_WINDOW_DEPTH;
+        for (uint8_t n = 0; n < window->count; n++) {
+            uint8_t i = (window->head + PHASE_WINDOW_DEPTH - 1 - n) % PHASE_WINDOW_DEPTH;
+            if (t_us - window->t_us[i] >= window->window_us) {
+                ref = i;
+                break;
+            }
+        }
+        delta = value - window->value[ref];
+    }
+
+    window->t_us[window->head] = t_us;
+    window->value[window->head] = value;
+    window->head = (window->head + 1) % PHASE_WINDOW_DEPTH;
+    if (window->count < PHASE_WINDOW_DEPTH) {
+        window->count++;
+    }
+    return delta;
+}
+
+// Shift the stored history by a known offset, so deltas across the shift stay valid
+void phase_window_rebase(phase_window_t *window, long offset) {
+    for (uint8_t i = 0; i < PHASE_WINDOW_DEPTH; i++) {
+        window->value[i] += offset;
+    }
+}
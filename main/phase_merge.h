@@ -0,0 +1,72 @@
+#ifndef PHASE_MERGE_H
+#define PHASE_MERGE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define PHASE_MAX_CELLS 4
+#define PHASE_PERIOD_FRAC_BITS 8 // Q8 microseconds for the tracked conversion period
+#define PHASE_PERIOD_SMOOTHING 4 // Period EMA weight, 1 / 2^n
+#define PHASE_WINDOW_DEPTH (2 * PHASE_MAX_CELLS + 1)
+
+/* How the other cells of a panel are brought onto the timestamp of a new conversion.
+   Hold keeps their last conversion: no added latency or noise, but a change only
+   shows in full once every cell has converted. Extrapolation carries each cell's
+   last slope up to one period forward: lowest latency, but it amplifies noise and
+   overshoots when a ramp stops, which reads as a ghost press after a release.
+   Interpolation places each estimate one nominal period in the past, where every
+   cell has samples on both sides: no noise gain, one period of latency.
+   test/phase_merge_sim.c measures all three. */
+typedef enum {
+    PHASE_MERGE_HOLD,
+    PHASE_MERGE_EXTRAPOLATE,
+    PHASE_MERGE_INTERPOLATE,
+} phase_merge_mode_t;
+
+/* One HX711 converting on its own oscillator. The phase is the DRDY time of the
+   last conversion; drift shows up as the tracked period moving off nominal. */
+typedef struct {
+    int64_t last_us;
+    int64_t prev_us;
+    long last_value;
+    long prev_value;
+    int32_t period_q8;
+    uint32_t conversions;
+    uint32_t missed; // Conversions inferred from DRDY gaps but never read
+} phase_cell_t;
+
+/* A panel whose load cells convert at staggered phases. Each conversion of any
+   cell produces one panel estimate, so a panel with N cells yields N estimates
+   per conversion period on a single time-ordered timeline. */
+typedef struct {
+    uint8_t cells;
+    phase_merge_mode_t mode;
+    uint32_t nominal_period_us;
+    int64_t last_in_us;
+    phase_cell_t cell[PHASE_MAX_CELLS];
+} phase_panel_t;
+
+typedef struct {
+    int64_t t_us; // Position on the panel timeline, one period behind DRDY when interpolating
+    long value;
+} phase_sample_t;
+
+/* Step detection over a fixed time window instead of between consecutive samples,
+   so a faster stream doesn't shrink the per-sample delta of a ramp. */
+typedef struct {
+    uint32_t window_us;
+    uint8_t head;
+    uint8_t count;
+    int64_t t_us[PHASE_WINDOW_DEPTH];
+    long value[PHASE_WINDOW_DEPTH];
+} phase_window_t;
+
+void phase_panel_init(phase_panel_t *panel, uint8_t cells, uint32_t nominal_period_us, phase_merge_mode_t mode);
+bool phase_panel_push(phase_panel_t *panel, uint8_t cell, int64_t drdy_us, long value, phase_sample_t *out);
+uint32_t phase_cell_period_us(const phase_cell_t *cell);
+
+void phase_window_init(phase_window_t *window, uint8_t cells, uint32_t nominal_period_us);
+long phase_window_delta(phase_window_t *window, int64_t t_us, long value);
+void phase_window_rebase(phase_window_t *window, long offset);
+
+#endif // PHASE_MERGE_H
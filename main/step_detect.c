@@ -0,0 +1,32 @@
+#include <string.h>
+#include "step_detect.h"
+
+void step_detector_init(step_detector_t *detector) {
+    memset(detector, 0, sizeof(*detector));
+}
+
+// Feed one weight and its change since the caller's reference sample.
+// Returns whether the pad is pressed after this sample.
+bool step_detector_update(step_detector_t *detector, long weight, long delta, long threshold) {
+    if (!detector->primed) {
+        detector->level = weight - delta;
+        detector->primed = true;
+    }
+
+    if (!detector->pressed) {
+        if (delta > threshold) {
+            detector->pressed = true;
+        } else {
+            detector->level += (weight - detector->level) >> STEP_LEVEL_SMOOTHING;
+        }
+    } else if (weight - detector->level < threshold / 2) {
+        detector->pressed = false;
+    }
+
+    return detector->pressed;
+}
+
+// Move the level along with the weights, when they shift by a known offset
+void step_detector_rebase(step_detector_t *detector, long offset) {
+    detector->level += offset;
+}
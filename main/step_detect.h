@@ -0,0 +1,28 @@
+#ifndef STEP_DETECT_H
+#define STEP_DETECT_H
+
+#include <stdbool.h>
+
+#define STEP_LEVEL_SMOOTHING 3 // Released-level EMA weight, 1 / 2^n per sample
+
+/* Press latch for one pad. A press starts when the weight rises by more than the
+   threshold and is held for as long as the foot stays on the pad, so holds and
+   freeze arrows reach the host as a held button rather than a one-sample pulse.
+   It ends when the weight returns to within half the threshold of the released
+   level. A falling delta alone doesn't release: the drop from a stomp's impact
+   peak to standing weight can exceed the threshold.
+
+   The released level is a slow average of the weight between presses, so it
+   follows drift, and a single low sample just before a rise can't latch the pad
+   against a level it will never return to. */
+typedef struct {
+    bool pressed;
+    bool primed; // level holds a weight
+    long level;
+} step_detector_t;
+
+void step_detector_init(step_detector_t *detector);
+bool step_detector_update(step_detector_t *detector, long weight, long delta, long threshold);
+void step_detector_rebase(step_detector_t *detector, long offset);
+
+#endif // STEP_DETECT_H
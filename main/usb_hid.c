@@ -0,0 +1,96 @@
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "tinyusb.h"
+#include "class/hid/hid_device.h"
+#include "usb_hid.h"
+
+#define TAG "USB_HID"
+
+#define HID_POLL_INTERVAL_MS 1 // bInterval for the interrupt IN endpoint, 1 ms = 1 kHz
+#define HID_EP_IN 0x81
+#define HID_EP_SIZE 16
+
+#define TUSB_DESC_TOTAL_LEN (TUD_CONFIG_DESC_LEN + CFG_TUD_HID * TUD_HID_DESC_LEN)
+
+static pad_report_scheduler_t scheduler;
+
+static const uint8_t hid_report_descriptor[] = {
+    TUD_HID_REPORT_DESC_GAMEPAD()
+};
+
+static const char* hid_string_descriptor[5] = {
+    (char[]){0x09, 0x04}, // Supported language: English (0x0409)
+    "DDR Pad",            // Manufacturer
+    "DDR Dance Pad",      // Product
+    "000001",             // Serial
+    "DDR Pad Gamepad",    // HID interface
+};
+
+static const uint8_t hid_configuration_descriptor[] = {
+    // Configuration number, interface count, string index, total length, attribute, power in mA
+    TUD_CONFIG_DESCRIPTOR(1, 1, 0, TUSB_DESC_TOTAL_LEN, TUSB_DESC_CONFIG_ATT_REMOTE_WAKEUP, 100),
+
+    // Interface number, string index, boot protocol, report descriptor len, EP In address, size & polling interval
+    TUD_HID_DESCRIPTOR(0, 4, false, sizeof(hid_report_descriptor), HID_EP_IN, HID_EP_SIZE, HID_POLL_INTERVAL_MS),
+};
+
+// TinyUSB HID callbacks
+uint8_t const *tud_hid_descriptor_report_cb(uint8_t instance) {
+    return hid_report_descriptor;
+}
+
+uint16_t tud_hid_get_report_cb(uint8_t instance, uint8_t report_id, hid_report_type_t report_type, uint8_t* buffer, uint16_t reqlen) {
+    return 0;
+}
+
+void tud_hid_set_report_cb(uint8_t instance, uint8_t report_id, hid_report_type_t report_type, uint8_t const* buffer, uint16_t bufsize) {
+}
+
+// Hand the newest pad state to the USB stack once per frame
+static void usb_hid_task(void *pvParameter) {
+    while (1) {
+        if (tud_mounted() && tud_hid_ready()) {
+            pad_report_scheduler_frame(&scheduler, &pad_state);
+            tud_hid_report(0, scheduler.report, PAD_REPORT_SIZE);
+        }
+        vTaskDelay(pdMS_TO_TICKS(HID_POLL_INTERVAL_MS));
+    }
+}
+
+esp_err_t usb_hid_init(void) {
+    ESP_LOGI(TAG, "Initializing USB HID gamepad...");
+
+    pad_report_scheduler_init(&scheduler);
+
+    const tinyusb_config_t tusb_cfg = {
+        .device_descriptor = NULL,
+        .string_descriptor = hid_string_descriptor,
+        .string_descriptor_count = sizeof(hid_string_descriptor) / sizeof(hid_string_descriptor[0]),
+        .external_phy = false,
+        .configuration_descriptor = hid_configuration_descriptor,
+    };
+
+    esp_err_t ret = tinyusb_driver_install(&tusb_cfg);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to install TinyUSB driver: %s", esp_err_to_name(ret));
+        return ret;
+    }
+
+    if (xTaskCreate(&usb_hid_task, "usb_hid_task", 4096, NULL, configMAX_PRIORITIES - 2, NULL) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create USB HID task");
+        return ESP_ERR_NO_MEM;
+    }
+
+    ESP_LOGI(TAG, "USB HID gamepad initialized.");
+    return ESP_OK;
+}
+
+uint32_t usb_hid_get_frames(void) {
+    return scheduler.frames;
+}
+
+// USB frames whose report carried no change in pad state
+uint32_t usb_hid_get_idle_frames(void) {
+    return scheduler.idle_frames;
+}
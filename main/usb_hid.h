@@ -0,0 +1,13 @@
+#ifndef USB_HID_H
+#define USB_HID_H
+
+#include "esp_err.h"
+#include "pad_report.h"
+
+extern pad_state_mailbox_t pad_state;
+
+esp_err_t usb_hid_init(void);
+uint32_t usb_hid_get_frames(void);
+uint32_t usb_hid_get_idle_frames(void);
+
+#endif // USB_HID_H
@@ -0,0 +1,27 @@
+// Minimal assertion helpers shared by the host tests. A failed CHECK is reported
+// and counted but doesn't stop the test, so one run lists every failure.
+
+#ifndef CHECK_H
+#define CHECK_H
+
+#include <stdio.h>
+
+static int failures = 0;
+
+#define CHECK(cond) do { \
+    if (!(cond)) { \
+        fprintf(stderr, "%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #cond); \
+        failures++; \
+    } \
+} while (0)
+
+// Exit status for main(): 0 if every CHECK passed
+static inline int check_result(void) {
+    if (failures) {
+        fprintf(stderr, "%d check(s) failed\n", failures);
+        return 1;
+    }
+    return 0;
+}
+
+#endif // CHECK_H
@@ -0,0 +1,187 @@
+// Host test for the cross-talk calibration and decoupling matrix.
+// Synthetic frames are built from a known coupling matrix; after calibration only
+// the stomped pad may cross the step threshold.
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "check.h"
+#include "crosstalk.h"
+
+#define PADS 4
+#define THRESHOLD 10000 // Same delta threshold as main.c
+#define CAL_LOAD 50000
+#define STOMP_LOAD 60000
+#define BENCH_FRAMES 1000000
+
+// coupling[i][j]: share of a load on pad j that shows up on channel i
+static const double coupling[PADS][PADS] = {
+    {1.00, 0.25, 0.05, 0.20},
+    {0.20, 1.00, 0.25, 0.05},
+    {0.05, 0.20, 1.00, 0.25},
+    {0.25, 0.05, 0.20, 1.00},
+};
+
+static const long baseline[PADS] = {812345, -40210, 120999, 503};
+
+static void coupled_frame(const long *load, long *frame) {
+    for (int i = 0; i < PADS; i++) {
+        double v = baseline[i];
+        for (int j = 0; j < PADS; j++) {
+            v += coupling[i][j] * load[j];
+        }
+        frame[i] = (long)v;
+    }
+}
+
+static void calibrate(crosstalk_cal_t *cal) {
+    crosstalk_cal_init(cal, PADS);
+    crosstalk_cal_set_baseline(cal, baseline);
+    for (int pad = 0; pad < PADS; pad++) {
+        long load[PADS] = {0};
+        long frame[PADS];
+        load[pad] = CAL_LOAD;
+        coupled_frame(load, frame);
+        CHECK(crosstalk_cal_record_pad(cal, pad, frame));
+    }
+}
+
+// Pads whose delta between two frames crosses the threshold
+static unsigned pressed_pads(const crosstalk_matrix_t *matrix, const long *before, const long *after) {
+    long a[PADS], b[PADS];
+    unsigned pressed = 0;
+    crosstalk_apply(matrix, before, a);
+    crosstalk_apply(matrix, after, b);
+    for (int i = 0; i < PADS; i++) {
+        if (b[i] - THRESHOLD > a[i]) {
+            pressed |= 1u << i;
+        }
+    }
+    return pressed;
+}
+
+static void test_ghost_presses_removed(void) {
+    crosstalk_cal_t cal;
+    crosstalk_matrix_t identity, matrix;
+    calibrate(&cal);
+    CHECK(crosstalk_cal_solve(&cal, THRESHOLD, &matrix));
+    crosstalk_matrix_identity(&identity, PADS);
+
+    long idle[PADS];
+    long none[PADS] = {0};
+    coupled_frame(none, idle);
+
+    unsigned ghosts_before = 0;
+    for (int pad = 0; pad < PADS; pad++) {
+        long load[PADS] = {0};
+        long stomp[PADS];
+        load[pad] = STOMP_LOAD;
+        coupled_frame(load, stomp);
+
+        unsigned raw = pressed_pads(&identity, idle, stomp);
+        unsigned decoupled = pressed_pads(&matrix, idle, stomp);
+        CHECK(raw & (1u << pad));
+        ghosts_before += __builtin_popcount(raw & ~(1u << pad));
+        CHECK(decoupled == 1u << pad);
+
+        // Decoupled deltas recover the true load on every channel
+        long a[PADS], b[PADS];
+        crosstalk_apply(&matrix, idle, a);
+        crosstalk_apply(&matrix, stomp, b);
+        for (int i = 0; i < PADS; i++) {
+            long expected = (i == pad) ? STOMP_LOAD : 0;
+            long err = (b[i] - a[i]) - expected;
+            CHECK(err >= -2 && err <= 2);
+        }
+    }
+
+    // The coupling above is strong enough to ghost without decoupling
+    CHECK(ghosts_before > 0);
+    printf("crosstalk: %u ghost presses without decoupling, 0 with\n", ghosts_before);
+}
+
+static void test_solve_rejects_bad_calibration(void) {
+    crosstalk_cal_t cal;
+    crosstalk_matrix_t matrix;
+
+    // A pad was never recorded
+    crosstalk_cal_init(&cal, PADS);
+    crosstalk_cal_set_baseline(&cal, baseline);
+    for (int pad = 0; pad < PADS - 1; pad++) {
+        long frame[PADS];
+        long load[PADS] = {0};
+        load[pad] = CAL_LOAD;
+        coupled_frame(load, frame);
+        crosstalk_cal_record_pad(&cal, pad, frame);
+    }
+    CHECK(!crosstalk_cal_solve(&cal, THRESHOLD, &matrix));
+
+    // Out of range pad
+    long frame[PADS] = {0};
+    CHECK(!crosstalk_cal_record_pad(&cal, PADS, frame));
+
+    // Every pad's cell beats its neighbours, but each row sums to zero: singular
+    calibrate(&cal);
+    for (int i = 0; i < PADS; i++) {
+        for (int j = 0; j < PADS; j++) {
+            cal.response[i][j] = (i == j) ? CAL_LOAD : -CAL_LOAD / (PADS - 1);
+        }
+    }
+    CHECK(!crosstalk_cal_solve(&cal, THRESHOLD, &matrix));
+
+    // A pad that didn't respond at all
+    calibrate(&cal);
+    for (int i = 0; i < PADS; i++) {
+        cal.response[i][2] = 0;
+    }
+    CHECK(!crosstalk_cal_solve(&cal, THRESHOLD, &matrix));
+
+    // A near-dead pad: its own cell moved by a few counts of noise
+    calibrate(&cal);
+    cal.response[2][2] = 40;
+    CHECK(!crosstalk_cal_solve(&cal, THRESHOLD, &matrix));
+    cal.response[2][2] = THRESHOLD - 1;
+    CHECK(!crosstalk_cal_solve(&cal, THRESHOLD, &matrix));
+
+    // The wrong pad was loaded: a neighbour saw more than the pad's own cell
+    calibrate(&cal);
+    cal.response[3][2] = cal.response[2][2];
+    CHECK(!crosstalk_cal_solve(&cal, THRESHOLD, &matrix));
+
+    // The same calibration with a clear self-response is accepted
+    calibrate(&cal);
+    CHECK(crosstalk_cal_solve(&cal, THRESHOLD, &matrix));
+}
+
+static void bench_apply(void) {
+    crosstalk_cal_t cal;
+    crosstalk_matrix_t matrix;
+    calibrate(&cal);
+    CHECK(crosstalk_cal_solve(&cal, THRESHOLD, &matrix));
+
+    long in[PADS];
+    long out[PADS];
+    volatile long sink = 0;
+    memcpy(in, baseline, sizeof(in));
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (long n = 0; n < BENCH_FRAMES; n++) {
+        in[n & (PADS - 1)] += 1;
+        crosstalk_apply(&matrix, in, out);
+        sink += out[0];
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    double ns = (end.tv_sec - start.tv_sec) * 1e9 + (end.tv_nsec - start.tv_nsec);
+    printf("crosstalk: crosstalk_apply %dx%d Q%d, %.1f ns/frame on the host (%d multiply-accumulates)\n",
+           PADS, PADS, CROSSTALK_FRAC_BITS, ns / BENCH_FRAMES, PADS * PADS);
+}
+
+int main(void) {
+    test_ghost_presses_removed();
+    test_solve_rejects_bad_calibration();
+    bench_apply();
+
+    return check_result();
+}
@@ -0,0 +1,111 @@
+// Host test for the USB HID report encoder and state-to-report scheduler.
+// USB frames are simulated at 1 ms; detections land at arbitrary times within
+// a frame and the report for the following frame must carry them.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "check.h"
+#include "pad_report.h"
+
+#define FRAME_US 1000
+
+static uint16_t report_buttons(const uint8_t *report) {
+    return report[PAD_REPORT_BUTTONS_OFFSET] | (report[PAD_REPORT_BUTTONS_OFFSET + 1] << 8);
+}
+
+static void test_encode(void) {
+    uint8_t buf[PAD_REPORT_SIZE + 1];
+    for (size_t i = 0; i < sizeof(buf); i++) {
+        buf[i] = 0xAA;
+    }
+
+    CHECK(pad_report_encode(0x0005, buf, PAD_REPORT_SIZE - 1) == 0);
+    CHECK(buf[0] == 0xAA); // Short buffer left untouched
+
+    CHECK(pad_report_encode(0x0205, buf, sizeof(buf)) == PAD_REPORT_SIZE);
+    for (int i = 0; i < PAD_REPORT_HAT_OFFSET; i++) {
+        CHECK(buf[i] == 0); // Axes centred
+    }
+    CHECK(buf[PAD_REPORT_HAT_OFFSET] == PAD_REPORT_HAT_CENTERED);
+    CHECK(buf[PAD_REPORT_BUTTONS_OFFSET + 0] == 0x05);
+    CHECK(buf[PAD_REPORT_BUTTONS_OFFSET + 1] == 0x02);
+    CHECK(buf[PAD_REPORT_BUTTONS_OFFSET + 2] == 0);
+    CHECK(buf[PAD_REPORT_BUTTONS_OFFSET + 3] == 0);
+    CHECK(buf[PAD_REPORT_SIZE] == 0xAA); // Nothing written past the report
+}
+
+static void test_mailbox(void) {
+    pad_state_mailbox_t mailbox = {0};
+
+    pad_state_publish(&mailbox, 0x1);
+    pad_state_t a = pad_state_latest(&mailbox);
+    pad_state_publish(&mailbox, 0x1); // Unchanged state keeps the sequence
+    pad_state_t b = pad_state_latest(&mailbox);
+    pad_state_publish(&mailbox, 0x3);
+    pad_state_t c = pad_state_latest(&mailbox);
+
+    CHECK(a.buttons == 0x1 && b.buttons == 0x1 && c.buttons == 0x3);
+    CHECK(a.seq == b.seq);
+    CHECK(c.seq == (uint16_t)(a.seq + 1));
+}
+
+// Detections at pseudo-random times, one scheduler step per simulated USB frame
+static void test_latency(void) {
+    pad_state_mailbox_t mailbox = {0};
+    pad_report_scheduler_t scheduler;
+    pad_report_scheduler_init(&scheduler);
+
+    const int frames = 10000;
+    int64_t next_event_us = 1234;
+    int64_t pending_us = -1;
+    uint16_t buttons = 0;
+    uint32_t changes = 0;
+    int64_t latency_sum_us = 0;
+    int64_t latency_max_us = 0;
+    srand(1);
+
+    for (int frame = 1; frame <= frames; frame++) {
+        int64_t frame_us = (int64_t)frame * FRAME_US;
+
+        // Detector publishes every event that happened before this frame
+        while (next_event_us < frame_us) {
+            buttons ^= 1 << (rand() % 4);
+            pad_state_publish(&mailbox, buttons);
+            if (pending_us < 0) {
+                pending_us = next_event_us;
+            }
+            next_event_us += 1 + rand() % (8 * FRAME_US);
+        }
+
+        bool changed = pad_report_scheduler_frame(&scheduler, &mailbox);
+        CHECK(report_buttons(scheduler.report) == buttons);
+        CHECK(scheduler.report[PAD_REPORT_HAT_OFFSET] == PAD_REPORT_HAT_CENTERED);
+        CHECK(changed == (pending_us >= 0));
+
+        if (pending_us >= 0) {
+            int64_t latency = frame_us - pending_us;
+            CHECK(latency > 0 && latency <= FRAME_US);
+            latency_sum_us += latency;
+            if (latency > latency_max_us) {
+                latency_max_us = latency;
+            }
+            changes++;
+            pending_us = -1;
+        }
+    }
+
+    CHECK(scheduler.frames == (uint32_t)frames);
+    CHECK(scheduler.idle_frames == frames - changes);
+
+    printf("pad_report: %u state changes over %d frames, latency mean %.3f max %.3f frames, %u idle frames\n",
+           (unsigned)changes, frames, (double)latency_sum_us / changes / FRAME_US,
+           (double)latency_max_us / FRAME_US, (unsigned)scheduler.idle_frames);
+}
+
+int main(void) {
+    test_encode();
+    test_mailbox();
+    test_latency();
+
+    return check_result();
+}
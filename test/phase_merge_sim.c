@@ -0,0 +1,314 @@
+// Host simulation of phase-staggered sampling on one panel with four load cells.
+// Each HX711 runs on its own oscillator, offset from nominal and drifting at a
+// different rate. Stomps ramp the panel load up over RAMP_US; the simulation
+// compares the fixed-order loop hx711_task used before with the merged stream
+// from phase_merge.c, and reports the effective sample interval, step timing
+// error, latency and the noise gain of each merge mode.
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "check.h"
+#include "phase_merge.h"
+#include "step_detect.h"
+
+#define CELLS 4
+#define PERIOD_US 12500        // Nominal HX711 conversion period at 80 SPS
+#define THRESHOLD 10000        // Same delta threshold as main.c
+#define LOAD 40000             // Panel load of a stomp, shared equally by the cells
+#define RAMP_US 20000          // Stomp rise time
+#define HOLD_US 150000
+#define TRIAL_US 400000
+#define TRIALS 500
+#define NOISE 300.0            // Per-conversion noise of one cell, counts RMS
+
+// Oscillator offset from nominal, and how fast each one drifts (fraction per second)
+static const double offset[CELLS] = {+0.010, -0.015, +0.003, -0.005};
+static const double drift[CELLS] = {+0.004, -0.002, +0.006, -0.003};
+static const double start_phase_us[CELLS] = {0, 3100, 6300, 9400};
+
+static uint64_t rng = 0x2545F4914F6CDD1DULL;
+
+static double uniform(void) {
+    rng ^= rng << 13;
+    rng ^= rng >> 7;
+    rng ^= rng << 17;
+    return (double)(rng >> 11) / (double)(1ULL << 53);
+}
+
+static double gaussian(void) {
+    double u = uniform(), v = uniform();
+    return sqrt(-2.0 * log(u + 1e-300)) * cos(2.0 * M_PI * v);
+}
+
+static double cell_period_us(int cell, double t_us) {
+    return PERIOD_US * (1.0 + offset[cell] + drift[cell] * t_us * 1e-6);
+}
+
+static double onset_us[TRIALS];
+
+static double panel_load(double t_us) {
+    int trial = (int)(t_us / TRIAL_US);
+    if (trial < 0 || trial >= TRIALS) {
+        return 0;
+    }
+
+    double on = onset_us[trial];
+    if (t_us < on) {
+        return 0;
+    }
+    if (t_us < on + RAMP_US) {
+        return LOAD * (t_us - on) / RAMP_US;
+    }
+    if (t_us < on + RAMP_US + HOLD_US) {
+        return LOAD;
+    }
+    if (t_us < on + 2 * RAMP_US + HOLD_US) {
+        return LOAD * (1.0 - (t_us - on - RAMP_US - HOLD_US) / RAMP_US);
+    }
+    return 0;
+}
+
+typedef struct {
+    const char *name;
+    int detected;
+    int retriggers;           // Extra presses while the foot is still down (threshold chatter)
+    int false_presses;        // Presses with no stomp starting
+    double err_sum, err_sq;   // Detection timestamp - onset, on the stream's timeline
+    double lat_sum;           // Wall-clock detection time - onset
+    double interval_sum;
+    long outputs;
+    double last_t;
+    int armed_trial;          // Trial waiting for its first press
+    bool was_pressed;
+    step_detector_t latch;    // Same press latch as hx711_task
+} pipeline_t;
+
+static void pipeline_init(pipeline_t *p, const char *name) {
+    memset(p, 0, sizeof(*p));
+    p->name = name;
+    p->last_t = -1;
+    p->armed_trial = -1;
+    step_detector_init(&p->latch);
+}
+
+// Feed one detector decision; t_us is the timeline position, wall_us when it was made
+static void pipeline_sample(pipeline_t *p, double t_us, double wall_us, bool pressed) {
+    if (p->last_t >= 0) {
+        p->interval_sum += t_us - p->last_t;
+    }
+    p->last_t = t_us;
+    p->outputs++;
+
+    int trial = (int)(t_us / TRIAL_US);
+    bool rising = pressed && !p->was_pressed;
+    p->was_pressed = pressed;
+    if (!rising || trial < 0 || trial >= TRIALS) {
+        return;
+    }
+
+    /* A press is genuine if it falls between the onset and the end of the ramp plus
+       one period. Interpolation can place it up to a period early: a linear segment
+       between conversions either side of the onset starts rising before it. */
+    double on = onset_us[trial];
+    if (t_us >= on - PERIOD_US && t_us <= on + RAMP_US + PERIOD_US && p->armed_trial != trial) {
+        double err = t_us - on;
+        p->armed_trial = trial;
+        p->detected++;
+        p->err_sum += err;
+        p->err_sq += err * err;
+        p->lat_sum += wall_us - on;
+    } else if (p->armed_trial == trial && t_us < on + RAMP_US + HOLD_US) {
+        p->retriggers++;
+    } else {
+        p->false_presses++;
+    }
+}
+
+static double pipeline_err_std(const pipeline_t *p) {
+    double mean = p->err_sum / p->detected;
+    return sqrt(p->err_sq / p->detected - mean * mean);
+}
+
+static void pipeline_report(const pipeline_t *p) {
+    if (p->detected == 0) {
+        printf("  %-36s interval %6.0f us  detected %3d/%d\n", p->name, p->interval_sum / (p->outputs - 1),
+               p->detected, TRIALS);
+        return;
+    }
+    printf("  %-36s interval %6.0f us  detected %3d/%d  timing error mean %6.0f std %5.0f us  latency %6.0f us  "
+           "retriggers %3d  false %3d\n",
+           p->name, p->interval_sum / (p->outputs - 1), p->detected, TRIALS,
+           p->err_sum / p->detected, pipeline_err_std(p), p->lat_sum / p->detected, p->retriggers, p->false_presses);
+}
+
+/* Noise gain of a merge mode: RMS of the panel estimate under constant load,
+   relative to the RMS of a plain sum of fresh conversions (2 * NOISE for 4 cells) */
+static double noise_gain(phase_merge_mode_t mode) {
+    phase_panel_t panel;
+    phase_panel_init(&panel, CELLS, PERIOD_US, mode);
+
+    double next[CELLS];
+    for (int i = 0; i < CELLS; i++) {
+        next[i] = start_phase_us[i];
+    }
+
+    double sum_sq = 0;
+    long n = 0;
+    for (int k = 0; k < 40000; k++) {
+        int c = 0;
+        for (int i = 1; i < CELLS; i++) {
+            if (next[i] < next[c]) {
+                c = i;
+            }
+        }
+        double t = next[c];
+        next[c] += cell_period_us(c, t);
+
+        phase_sample_t out;
+        if (phase_panel_push(&panel, c, (int64_t)t, (long)lround(NOISE * gaussian()), &out) && k > 100) {
+            sum_sq += (double)out.value * out.value;
+            n++;
+        }
+    }
+    return sqrt(sum_sq / n) / (2.0 * NOISE);
+}
+
+#define MODES 3
+
+static const phase_merge_mode_t modes[MODES] = {PHASE_MERGE_HOLD, PHASE_MERGE_EXTRAPOLATE, PHASE_MERGE_INTERPOLATE};
+static const char *const mode_names[MODES] = {"hold", "extrapolate", "interpolate"};
+
+int main(void) {
+    for (int t = 0; t < TRIALS; t++) {
+        onset_us[t] = (double)t * TRIAL_US + 50000 + uniform() * 100000;
+    }
+
+    pipeline_t fixed, consecutive;
+    pipeline_t windowed[MODES];
+    phase_panel_t panels[MODES];
+    phase_window_t windows[MODES];
+    char names[MODES][48];
+
+    pipeline_init(&fixed, "fixed-order loop (before)");
+    pipeline_init(&consecutive, "staggered hold, consecutive delta");
+    for (int m = 0; m < MODES; m++) {
+        snprintf(names[m], sizeof(names[m]), "staggered %s, window delta", mode_names[m]);
+        pipeline_init(&windowed[m], names[m]);
+        phase_panel_init(&panels[m], CELLS, PERIOD_US, modes[m]);
+        phase_window_init(&windows[m], CELLS, PERIOD_US);
+    }
+
+    double next[CELLS];
+    long latest[CELLS] = {0};
+    for (int i = 0; i < CELLS; i++) {
+        next[i] = start_phase_us[i];
+    }
+
+    double next_loop_us = 5000;
+    long fixed_prev = 0, consecutive_prev = 0;
+    bool have_consecutive = false;
+    const double end_us = (double)TRIALS * TRIAL_US;
+
+    while (1) {
+        int c = 0;
+        for (int i = 1; i < CELLS; i++) {
+            if (next[i] < next[c]) {
+                c = i;
+            }
+        }
+        double t = next[c];
+        if (t >= end_us) {
+            break;
+        }
+
+        // The old loop sums whatever each chip converted last, once per period
+        while (next_loop_us <= t) {
+            long sum = 0;
+            for (int i = 0; i < CELLS; i++) {
+                sum += latest[i];
+            }
+            pipeline_sample(&fixed, next_loop_us, next_loop_us,
+                            step_detector_update(&fixed.latch, sum, sum - fixed_prev, THRESHOLD));
+            fixed_prev = sum;
+            next_loop_us += PERIOD_US;
+        }
+
+        next[c] += cell_period_us(c, t);
+        long value = (long)lround(panel_load(t) / CELLS + NOISE * gaussian());
+        latest[c] = value;
+
+        for (int m = 0; m < MODES; m++) {
+            phase_sample_t out;
+            if (!phase_panel_push(&panels[m], c, (int64_t)t, value, &out)) {
+                continue;
+            }
+
+            long delta = phase_window_delta(&windows[m], out.t_us, out.value);
+            pipeline_sample(&windowed[m], out.t_us, t,
+                            step_detector_update(&windowed[m].latch, out.value, delta, THRESHOLD));
+
+            if (modes[m] == PHASE_MERGE_HOLD) {
+                if (have_consecutive) {
+                    pipeline_sample(&consecutive, out.t_us, t, step_detector_update(&consecutive.latch, out.value,
+                                                                                    out.value - consecutive_prev,
+                                                                                    THRESHOLD));
+                }
+                consecutive_prev = out.value;
+                have_consecutive = true;
+            }
+        }
+    }
+
+    printf("phase_merge: %d cells, %d us nominal period, oscillators -1.5%% .. +1.0%% drifting up to 0.6%%/s, "
+           "%d stomps ramping over %d us, %.0f counts noise per cell\n", CELLS, PERIOD_US, TRIALS, RAMP_US, NOISE);
+    pipeline_report(&fixed);
+    for (int m = 0; m < MODES; m++) {
+        pipeline_report(&windowed[m]);
+    }
+    pipeline_report(&consecutive);
+
+    double gain[MODES];
+    for (int m = 0; m < MODES; m++) {
+        gain[m] = noise_gain(modes[m]);
+    }
+    printf("  noise gain vs a fresh sum: hold %.2f, extrapolate %.2f, interpolate %.2f\n", gain[0], gain[1], gain[2]);
+
+    double worst_period_err = 0;
+    for (int i = 0; i < CELLS; i++) {
+        double actual = cell_period_us(i, end_us);
+        double err = fabs(phase_cell_period_us(&panels[0].cell[i]) - actual) / actual;
+        if (err > worst_period_err) {
+            worst_period_err = err;
+        }
+        CHECK(panels[0].cell[i].missed == 0);
+    }
+    printf("  tracked period error at end of run: %.3f%% worst cell\n", worst_period_err * 100);
+    for (int m = 0; m < MODES; m++) {
+        printf("  %s: timing error std reduced %.1fx\n", mode_names[m],
+               pipeline_err_std(&fixed) / pipeline_err_std(&windowed[m]));
+    }
+
+    for (int m = 0; m < MODES; m++) {
+        double interval = windowed[m].interval_sum / (windowed[m].outputs - 1);
+        CHECK(fabs(interval - PERIOD_US / CELLS) < 0.1 * PERIOD_US / CELLS);
+        CHECK(windowed[m].detected >= TRIALS * 99 / 100);
+        CHECK(pipeline_err_std(&windowed[m]) < 0.6 * pipeline_err_std(&fixed));
+    }
+    CHECK(fixed.detected >= TRIALS * 99 / 100);
+
+    // Hold and interpolation sharpen step timing without ghost presses
+    CHECK(windowed[0].false_presses == 0 && windowed[2].false_presses == 0);
+    CHECK(windowed[0].retriggers <= fixed.retriggers && windowed[2].retriggers <= fixed.retriggers);
+    CHECK(gain[2] <= gain[0] && gain[0] < gain[1]);
+
+    // Extrapolation overshoots when a release ramp stops
+    CHECK(windowed[1].false_presses > 0);
+
+    // A consecutive-sample delta at 4x the rate sees a quarter of the ramp and misses stomps
+    CHECK(consecutive.detected < TRIALS / 2);
+    CHECK(worst_period_err < 0.005);
+
+    return check_result();
+}
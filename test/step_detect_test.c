@@ -0,0 +1,163 @@
+// Host test for the pad press latch, driven the way hx711_task drives it and read
+// back through the USB HID report path. A stomp ramps up, overshoots on impact,
+// is held and released; the report must stay pressed for the whole hold, at the
+// 1 ms USB frame rate and at a game's 60 Hz poll.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "check.h"
+#include "pad_report.h"
+#include "step_detect.h"
+
+#define THRESHOLD 10000        // Same delta threshold as main.c
+#define SAMPLE_US 12500        // hx711_task frame period, one HX711 conversion at 80 SPS
+#define FRAME_US 1000          // USB HID poll interval
+#define POLL_US 16667          // Game reading the gamepad at 60 Hz
+#define PAD 2                  // Report bit under test
+#define OFFSET 812345          // Absolute HX711 reading of the unloaded pad
+#define LOAD 40000             // Standing weight on the pad
+#define NOISE 300              // Peak sample noise, counts
+
+#define ONSET_US 200000
+#define RAMP_US 20000          // Release ramp; a press must also be reported within it
+#define PEAK_US 40000          // Impact peak after onset, 1.6x standing weight
+#define SETTLE_US 100000       // Back to standing weight after onset
+#define RELEASE_US 1200000     // Foot starts lifting
+#define END_US 1600000
+
+static uint64_t rng = 0x9E3779B97F4A7C15ULL;
+
+static long noise(void) {
+    rng ^= rng << 13;
+    rng ^= rng >> 7;
+    rng ^= rng << 17;
+    return (long)(rng % (2 * NOISE + 1)) - NOISE;
+}
+
+// Load on the pad at time t: ramp, impact overshoot, settle, hold, release ramp
+static long stomp_load(int64_t t) {
+    if (t < ONSET_US || t >= RELEASE_US + RAMP_US) {
+        return 0;
+    }
+    if (t < ONSET_US + PEAK_US) {
+        return (long)((int64_t)LOAD * 16 / 10 * (t - ONSET_US) / PEAK_US);
+    }
+    if (t < ONSET_US + SETTLE_US) {
+        return LOAD * 16 / 10 - (long)((int64_t)LOAD * 6 / 10 * (t - ONSET_US - PEAK_US) / (SETTLE_US - PEAK_US));
+    }
+    if (t < RELEASE_US) {
+        return LOAD;
+    }
+    return LOAD - (long)((int64_t)LOAD * (t - RELEASE_US) / RAMP_US);
+}
+
+static bool report_pressed(const uint8_t *report) {
+    uint16_t buttons = report[PAD_REPORT_BUTTONS_OFFSET] | (report[PAD_REPORT_BUTTONS_OFFSET + 1] << 8);
+    return buttons & (1 << PAD);
+}
+
+static void test_hold(void) {
+    pad_state_mailbox_t mailbox = {0};
+    pad_report_scheduler_t scheduler;
+    step_detector_t detector;
+    pad_report_scheduler_init(&scheduler);
+    step_detector_init(&detector);
+
+    int64_t next_sample_us = 3100; // Arbitrary phase against the USB frames
+    int64_t next_poll_us = 0;
+    long prev = 0;
+    bool seeded = false;
+    int64_t pressed_at = -1, released_at = -1;
+    int64_t edge_held_us = 0; // How long a rising-edge-only detector reports the press
+    int polls_in_hold = 0, polls_pressed = 0;
+
+    for (int64_t t = 0; t < END_US; t += FRAME_US) {
+        while (next_sample_us <= t) {
+            long weight = OFFSET + stomp_load(next_sample_us) + noise();
+            if (seeded) {
+                bool pressed = step_detector_update(&detector, weight, weight - prev, THRESHOLD);
+                pad_state_publish(&mailbox, pressed ? 1 << PAD : 0);
+                if (weight - prev > THRESHOLD) {
+                    edge_held_us += SAMPLE_US;
+                }
+            }
+            prev = weight;
+            seeded = true;
+            next_sample_us += SAMPLE_US;
+        }
+
+        pad_report_scheduler_frame(&scheduler, &mailbox);
+        bool pressed = report_pressed(scheduler.report);
+        if (pressed && pressed_at < 0) {
+            pressed_at = t;
+        }
+        if (!pressed && pressed_at >= 0 && released_at < 0) {
+            released_at = t;
+        }
+
+        // Before the onset and after the release, nothing may be reported
+        if (t < ONSET_US || t > RELEASE_US + RAMP_US + SAMPLE_US + FRAME_US) {
+            CHECK(!pressed);
+        }
+        // Once reported, the press holds through the impact, the settle and the hold
+        if (pressed_at >= 0 && t < RELEASE_US) {
+            CHECK(pressed);
+        }
+
+        if (t >= next_poll_us) {
+            if (t > ONSET_US + RAMP_US + SAMPLE_US + FRAME_US && t < RELEASE_US) {
+                polls_in_hold++;
+                polls_pressed += pressed;
+            }
+            next_poll_us += POLL_US;
+        }
+    }
+
+    CHECK(pressed_at > ONSET_US && pressed_at <= ONSET_US + RAMP_US + SAMPLE_US + FRAME_US);
+    CHECK(released_at > RELEASE_US && released_at <= RELEASE_US + RAMP_US + SAMPLE_US + FRAME_US);
+    CHECK(polls_in_hold > 0 && polls_pressed == polls_in_hold);
+
+    printf("step_detect: stomp held %lld ms, reported pressed %lld ms after onset to %lld ms after release; "
+           "%d/%d 60 Hz polls saw the hold (a rising-edge-only detector: %lld ms)\n",
+           (long long)(RELEASE_US - ONSET_US) / 1000, (long long)(pressed_at - ONSET_US) / 1000,
+           (long long)(released_at - RELEASE_US) / 1000, polls_pressed, polls_in_hold,
+           (long long)edge_held_us / 1000);
+}
+
+// A single high sample must not leave the pad latched
+static void test_spike(void) {
+    step_detector_t detector;
+    step_detector_init(&detector);
+
+    long prev = OFFSET;
+    for (int i = 0; i < 20; i++) {
+        long weight = OFFSET + (i == 10 ? 2 * THRESHOLD : 0) + noise();
+        bool pressed = step_detector_update(&detector, weight, weight - prev, THRESHOLD);
+        CHECK(pressed == (i == 10));
+        prev = weight;
+    }
+}
+
+// A dip, e.g. a neighbour's release settling, then recovery reads as a rising delta.
+// The released level only moves an eighth of the way into the dip, so the pad releases on the next sample.
+static void test_dip_recovery(void) {
+    step_detector_t detector;
+    step_detector_init(&detector);
+
+    long prev = OFFSET;
+    for (int i = 0; i < 20; i++) {
+        long weight = OFFSET + (i == 10 ? -2 * THRESHOLD : 0) + noise();
+        bool pressed = step_detector_update(&detector, weight, weight - prev, THRESHOLD);
+        CHECK(!pressed || i == 11);
+        prev = weight;
+    }
+    CHECK(!detector.pressed);
+}
+
+int main(void) {
+    test_hold();
+    test_spike();
+    test_dip_recovery();
+
+    return check_result();
+}
@@ -0,0 +1,229 @@
+#!/usr/bin/env python3
+"""Benchmark the firmware's networking paths under QEMU.
+
+Builds the firmware from the sdkconfig.qemu defaults (ESP32 target, OpenCores
+Ethernet instead of Wi-Fi, stubbed HX711 input), boots it in Espressif's
+qemu-system-xtensa with the HTTP port forwarded to the host, drives each httpd
+endpoint from a multi-threaded load generator and writes the results as JSON.
+
+Recorded per endpoint: requests per second, latency percentiles and errors.
+Recorded from /stats on the device: heap low-water mark, hx711_task stack
+low-water mark and sampling-loop period/jitter over the run.
+
+Run from the ESP-IDF environment (the devcontainer sources export.sh):
+
+    python tools/qemu_bench.py --output qemu_bench.json
+
+Limitations:
+- The image is built for and run on the ESP32 machine, not the pad's ESP32-S3.
+  The ESP32 is the target whose OpenCores Ethernet emulation ESP-IDF uses for
+  networking under QEMU; the S3 machine in the pinned QEMU
+  (esp_develop_8.2.0_20240122) is not relied on. USB HID output is not built.
+- QEMU does not run in real time, so numbers are only comparable between runs
+  on the same host. Use them to compare commits, not as device figures.
+"""
+
+import argparse
+import json
+import os
+import shutil
+import subprocess
+import sys
+import threading
+import time
+import urllib.error
+import urllib.request
+
+PROJECT_DIR = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+
+# (name, path) pairs driven by the load generator, see start_webserver() in main.c.
+# /calibrate is left out: its steps block on averaged HX711 reads and change state.
+ENDPOINTS = [
+    ("root", "/"),
+    ("hx711", "/hx711"),
+    ("stats", "/stats"),
+]
+
+
+def check_tools(need_build):
+    missing = [tool for tool in (["idf.py"] if need_build else []) + ["qemu-system-xtensa"]
+               if shutil.which(tool) is None]
+    if missing:
+        sys.exit("{} not found on PATH: run from the ESP-IDF environment with Espressif's QEMU "
+                 "installed, e.g. the devcontainer".format(", ".join(missing)))
+
+
+def build(build_dir, chip):
+    subprocess.check_call([
+        "idf.py", "-C", PROJECT_DIR, "-B", build_dir,
+        "-D", "IDF_TARGET=" + chip,
+        "-D", "SDKCONFIG=" + os.path.join(build_dir, "sdkconfig"),
+        "-D", "SDKCONFIG_DEFAULTS=" + os.path.join(PROJECT_DIR, "sdkconfig.qemu"),
+        "build",
+    ])
+
+
+def merge_flash_image(build_dir, chip, flash_size):
+    image = os.path.join(build_dir, "qemu_flash.bin")
+    subprocess.check_call([
+        sys.executable, "-m", "esptool", "--chip", chip, "merge_bin",
+        "--fill-flash-size", flash_size, "-o", image, "@flash_args",
+    ], cwd=build_dir)
+    return image
+
+
+def start_qemu(image, machine, port, log_path):
+    cmd = [
+        "qemu-system-xtensa", "-nographic",
+        "-machine", machine,
+        "-drive", "file={},if=mtd,format=raw".format(image),
+        "-nic", "user,model=open_eth,hostfwd=tcp:127.0.0.1:{}-:80".format(port),
+    ]
+    log = open(log_path, "wb")
+    return subprocess.Popen(cmd, stdin=subprocess.DEVNULL, stdout=log, stderr=subprocess.STDOUT)
+
+
+def fetch(url, timeout):
+    with urllib.request.urlopen(url, timeout=timeout) as resp:
+        return resp.read()
+
+
+def wait_for_http(base_url, timeout):
+    deadline = time.monotonic() + timeout
+    while time.monotonic() < deadline:
+        try:
+            fetch(base_url + "/", 2)
+            return True
+        except (urllib.error.URLError, OSError):
+            time.sleep(0.5)
+    return False
+
+
+def percentile(sorted_values, p):
+    if not sorted_values:
+        return None
+    k = (len(sorted_values) - 1) * p / 100.0
+    lo = int(k)
+    hi = min(lo + 1, len(sorted_values) - 1)
+    return sorted_values[lo] + (sorted_values[hi] - sorted_values[lo]) * (k - lo)
+
+
+def run_load(url, duration, concurrency, timeout):
+    latencies = []
+    errors = [0]
+    lock = threading.Lock()
+    stop = time.monotonic() + duration
+
+    def worker():
+        local = []
+        local_errors = 0
+        while time.monotonic() < stop:
+            start = time.perf_counter()
+            try:
+                fetch(url, timeout)
+                local.append((time.perf_counter() - start) * 1000.0)
+            except (urllib.error.URLError, OSError):
+                local_errors += 1
+        with lock:
+            latencies.extend(local)
+            errors[0] += local_errors
+
+    started = time.monotonic()
+    threads = [threading.Thread(target=worker) for _ in range(concurrency)]
+    for t in threads:
+        t.start()
+    for t in threads:
+        t.join()
+    elapsed = time.monotonic() - started
+
+    latencies.sort()
+    return {
+        "requests": len(latencies),
+        "errors": errors[0],
+        "duration_s": round(elapsed, 3),
+        "requests_per_s": round(len(latencies) / elapsed, 2) if elapsed > 0 else 0,
+        "latency_ms": {
+            "min": latencies[0] if latencies else None,
+            "p50": percentile(latencies, 50),
+            "p90": percentile(latencies, 90),
+            "p99": percentile(latencies, 99),
+            "max": latencies[-1] if latencies else None,
+        },
+    }
+
+
+def device_stats(base_url, timeout, reset=False):
+    return json.loads(fetch(base_url + "/stats" + ("?reset=1" if reset else ""), timeout))
+
+
+def git_revision():
+    try:
+        return subprocess.check_output(["git", "-C", PROJECT_DIR, "rev-parse", "HEAD"], text=True).strip()
+    except (subprocess.CalledProcessError, OSError):
+        return None
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--build-dir", default=os.path.join(PROJECT_DIR, "build_qemu"))
+    parser.add_argument("--no-build", action="store_true", help="reuse an existing QEMU build")
+    parser.add_argument("--chip", default="esp32", help="IDF target and QEMU machine, see sdkconfig.qemu")
+    parser.add_argument("--flash-size", default="4MB")
+    parser.add_argument("--port", type=int, default=8080, help="host port forwarded to the device's port 80")
+    parser.add_argument("--duration", type=float, default=10.0, help="seconds of load per endpoint")
+    parser.add_argument("--concurrency", type=int, default=4)
+    parser.add_argument("--timeout", type=float, default=5.0, help="per-request timeout in seconds")
+    parser.add_argument("--boot-timeout", type=float, default=120.0)
+    parser.add_argument("--output", default="qemu_bench.json")
+    args = parser.parse_args()
+
+    check_tools(not args.no_build)
+
+    build_dir = os.path.abspath(args.build_dir)
+    if not args.no_build:
+        build(build_dir, args.chip)
+    image = merge_flash_image(build_dir, args.chip, args.flash_size)
+
+    log_path = os.path.join(build_dir, "qemu_bench.log")
+    qemu = start_qemu(image, args.chip, args.port, log_path)
+    base_url = "http://127.0.0.1:{}".format(args.port)
+
+    try:
+        if not wait_for_http(base_url, args.boot_timeout):
+            sys.exit("firmware did not answer HTTP within {}s, see {}".format(args.boot_timeout, log_path))
+
+        results = {}
+        for name, path in ENDPOINTS:
+            device_stats(base_url, args.timeout, reset=True)
+            load = run_load(base_url + path, args.duration, args.concurrency, args.timeout)
+            load["device"] = device_stats(base_url, args.timeout)
+            results[name] = load
+            print("{:8s} {:8.1f} req/s  p50 {:7.2f} ms  p99 {:7.2f} ms  errors {}".format(
+                name, load["requests_per_s"], load["latency_ms"]["p50"] or 0,
+                load["latency_ms"]["p99"] or 0, load["errors"]))
+
+        final = device_stats(base_url, args.timeout)
+    finally:
+        qemu.terminate()
+        try:
+            qemu.wait(timeout=10)
+        except subprocess.TimeoutExpired:
+            qemu.kill()
+
+    report = {
+        "revision": git_revision(),
+        "timestamp": time.strftime("%Y-%m-%dT%H:%M:%SZ", time.gmtime()),
+        "machine": args.chip,
+        "concurrency": args.concurrency,
+        "duration_per_endpoint_s": args.duration,
+        "endpoints": results,
+        "heap_min_free": final["heap_min_free"],
+        "hx711_task_stack_min_free": final["hx711_task_stack_min_free"],
+    }
+    with open(args.output, "w") as f:
+        json.dump(report, f, indent=2)
+    print("Results written to {}".format(args.output))
+
+
+if __name__ == "__main__":
+    main()